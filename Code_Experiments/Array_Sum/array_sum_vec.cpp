@@ -3,6 +3,8 @@
 #include <random>
 #include <chrono>
 #include "array_sum_ispc.h"
+#include "parallel_reduce.h"
+#include "../common/ispc_targets.h"
 
 // Serial sum function
 float serial_sum(int N, float* array) {
@@ -32,18 +34,34 @@ int main() {
     auto end = std::chrono::high_resolution_clock::now();
     auto serial_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
     
-    // Time ISPC implementation
+    // Time ISPC implementation (widest target the CPU supports, or ISPC_TARGET=sse4|avx2|avx512)
+    auto sum_array_kernel = ISPC_VARIANT(sum_array);
     start = std::chrono::high_resolution_clock::now();
-    float ispc_result = ispc::sum_array(numbers.size(), numbers.data());
+    float ispc_result = sum_array_kernel(numbers.size(), numbers.data());
     end = std::chrono::high_resolution_clock::now();
     auto ispc_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    // Time threads + ISPC implementation (parallel_reduce dispatches Sum<float> to sum_array)
+    start = std::chrono::high_resolution_clock::now();
+    float parallel_result = preduce::parallel_reduce<float, preduce::Sum<float>>(numbers.data(), numbers.size());
+    end = std::chrono::high_resolution_clock::now();
+    auto parallel_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
     
     // Print results
     std::cout << "Array size: " << N << " elements\n";
+    std::cout << "ISPC target: " << ispc_target_report() << "\n";
     std::cout << "Serial sum: " << serial_result << " (took " << serial_time << " microseconds)\n";
     std::cout << "ISPC sum:   " << ispc_result << " (took " << ispc_time << " microseconds)\n";
     std::cout << "Difference: " << std::abs(serial_result - ispc_result) << "\n";
     std::cout << "Speedup: " << (float)serial_time / ispc_time << "x\n";
+    std::cout << "Parallel sum: " << parallel_result << " (took " << parallel_time << " microseconds)\n";
+    std::cout << "Parallel speedup: " << (float)serial_time / parallel_time << "x\n";
+
+    // Other reductions from the same library
+    size_t max_index = preduce::argmax(numbers.data(), numbers.size());
+    std::cout << "Min: " << preduce::parallel_reduce(numbers.data(), numbers.size(), preduce::Min<float>())
+              << ", Max: " << numbers[max_index] << " at index " << max_index
+              << ", L2 norm: " << preduce::norm2(numbers.data(), numbers.size()) << "\n";
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,336 @@
+#ifndef PARALLEL_REDUCE_H
+#define PARALLEL_REDUCE_H
+
+#include <vector>
+#include <thread>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+#include "array_sum_ispc.h"
+#include "../common/ispc_targets.h"
+
+/*
+    Generic parallel reductions over large arrays.
+
+    parallel_reduce<T, Op>(x, n) and transform_reduce(x, n, f, op) split the
+    array into one chunk per thread (as in taylor_parallel), reduce every chunk
+    and combine the per-thread results with the operator.
+
+    Inside a chunk the work is picked at compile time: when an ISPC kernel
+    exists for the (operator, element type) pair, or (transform, operator, type)
+    triple, simd_kernel<...> dispatches to it; any other combination, including
+    user lambdas, goes through generic_chunk(), which keeps LANES independent
+    accumulators so the compiler can vectorize it.
+
+    An operator provides:
+        result_type                     what the reduction produces
+        identity()                      neutral element
+        lift(value, index)              element (after transform) -> result_type
+        combine(a, b)                   associative merge of two results
+*/
+
+// float sums follow the ISPC target selection (see ispc_targets.h)
+ISPC_DECLARE_VARIANTS(float, sum_array, (int N, float* array))
+
+namespace preduce {
+
+// ISPC kernels take an int element count, bigger chunks are walked in slices
+const size_t MAX_KERNEL_COUNT = size_t(1) << 30;
+// Independent accumulators of the generic path
+const int LANES = 8;
+
+// ---------------------------------------------------------------- operators
+
+template <typename T>
+struct Sum {
+    // integers accumulate in 64 bits so huge arrays don't overflow
+    using result_type = typename std::conditional<std::is_integral<T>::value, long long, T>::type;
+    result_type identity() const { return result_type(0); }
+    result_type lift(T x, size_t) const { return x; }
+    result_type combine(result_type a, result_type b) const { return a + b; }
+};
+
+template <typename T>
+struct Min {
+    using result_type = T;
+    T identity() const {
+        return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                    : std::numeric_limits<T>::max();
+    }
+    T lift(T x, size_t) const { return x; }
+    T combine(T a, T b) const { return b < a ? b : a; }
+};
+
+template <typename T>
+struct Max {
+    using result_type = T;
+    T identity() const {
+        return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                    : std::numeric_limits<T>::lowest();
+    }
+    T lift(T x, size_t) const { return x; }
+    T combine(T a, T b) const { return a < b ? b : a; }
+};
+
+// Largest element and the index of its first occurrence
+template <typename T>
+struct ArgMax {
+    struct result_type {
+        T value;
+        size_t index;
+    };
+    result_type identity() const { return { Max<T>().identity(), SIZE_MAX }; }
+    result_type lift(T x, size_t i) const { return { x, i }; }
+    result_type combine(result_type a, result_type b) const {
+        if (b.value > a.value || (b.value == a.value && b.index < a.index))
+            return b;
+        return a;
+    }
+};
+
+// ---------------------------------------------------------------- transforms
+
+struct Identity {
+    template <typename T> T operator()(T x) const { return x; }
+};
+
+template <typename T>
+struct Square {
+    T operator()(T x) const { return x * x; }
+};
+
+template <typename T>
+struct Multiply {
+    T operator()(T a, T b) const { return a * b; }
+};
+
+// ---------------------------------------------------------------- SIMD kernels
+
+// Primary templates: no specialized kernel, use the generic path
+template <typename Op, typename T>
+struct simd_kernel { static constexpr bool available = false; };
+
+template <typename F, typename Op, typename T>
+struct simd_transform_kernel { static constexpr bool available = false; };
+
+template <typename F, typename Op, typename T>
+struct simd_binary_kernel { static constexpr bool available = false; };
+
+template <>
+struct simd_kernel<Sum<float>, float> {
+    static constexpr bool available = true;
+    static float run(const float* x, int n, size_t) {
+        static const auto kernel = ISPC_VARIANT(sum_array);
+        return kernel(n, const_cast<float*>(x));
+    }
+};
+
+template <>
+struct simd_kernel<Sum<int>, int> {
+    static constexpr bool available = true;
+    static long long run(const int* x, int n, size_t) { return ispc::sum_array_int(n, const_cast<int*>(x)); }
+};
+
+template <>
+struct simd_kernel<Min<float>, float> {
+    static constexpr bool available = true;
+    static float run(const float* x, int n, size_t) { return ispc::min_array(n, const_cast<float*>(x)); }
+};
+
+template <>
+struct simd_kernel<Max<float>, float> {
+    static constexpr bool available = true;
+    static float run(const float* x, int n, size_t) { return ispc::max_array(n, const_cast<float*>(x)); }
+};
+
+template <>
+struct simd_kernel<ArgMax<float>, float> {
+    static constexpr bool available = true;
+    static ArgMax<float>::result_type run(const float* x, int n, size_t offset) {
+        int i = ispc::argmax_array(n, const_cast<float*>(x));
+        return { x[i], offset + i };
+    }
+};
+
+template <>
+struct simd_transform_kernel<Square<float>, Sum<float>, float> {
+    static constexpr bool available = true;
+    static float run(const float* x, int n) { return ispc::sum_squares_array(n, const_cast<float*>(x)); }
+};
+
+template <>
+struct simd_binary_kernel<Multiply<float>, Sum<float>, float> {
+    static constexpr bool available = true;
+    static float run(const float* x, const float* y, int n) {
+        return ispc::dot_array(n, const_cast<float*>(x), const_cast<float*>(y));
+    }
+};
+
+// ---------------------------------------------------------------- chunk reductions
+
+// Generic vectorizable path: f(i) produces the (transformed) element at index i
+template <typename Op, typename F>
+typename Op::result_type generic_chunk(size_t begin, size_t end, const Op& op, F f) {
+    using R = typename Op::result_type;
+    R acc[LANES];
+    for (int l = 0; l < LANES; l++)
+        acc[l] = op.identity();
+
+    size_t i = begin;
+    for (; i + LANES <= end; i += LANES)
+        for (int l = 0; l < LANES; l++)
+            acc[l] = op.combine(acc[l], op.lift(f(i + l), i + l));
+    for (; i < end; i++)
+        acc[0] = op.combine(acc[0], op.lift(f(i), i));
+
+    R result = acc[0];
+    for (int l = 1; l < LANES; l++)
+        result = op.combine(result, acc[l]);
+    return result;
+}
+
+// Function to walk [begin, end) in kernel-sized slices
+template <typename Op, typename Kernel>
+typename Op::result_type sliced(size_t begin, size_t end, const Op& op, Kernel kernel) {
+    typename Op::result_type result = op.identity();
+    for (size_t off = begin; off < end; off += MAX_KERNEL_COUNT) {
+        size_t len = std::min(MAX_KERNEL_COUNT, end - off);
+        result = op.combine(result, kernel(off, (int)len));
+    }
+    return result;
+}
+
+// Function to run chunk(begin, end) on num_threads threads and combine the results
+template <typename Op, typename Chunk>
+typename Op::result_type run_parallel(size_t n, const Op& op, int num_threads, Chunk chunk) {
+    using R = typename Op::result_type;
+    if (num_threads <= 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    if ((size_t)num_threads > n)
+        num_threads = std::max<size_t>(1, n);
+
+    std::vector<std::thread> threads(num_threads);
+    std::vector<R> partials(num_threads, op.identity());
+    size_t chunk_size = n / num_threads;
+    size_t remainder = n % num_threads;
+    size_t start_pos = 0;
+    for (int t = 0; t < num_threads; t++) {
+        size_t current_chunk = chunk_size + (t < (int)remainder ? 1 : 0);
+        size_t begin = start_pos, end = start_pos + current_chunk;
+        threads[t] = std::thread([&partials, &chunk, t, begin, end]() {
+            partials[t] = chunk(begin, end);
+        });
+        start_pos = end;
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    R result = op.identity();
+    for (const R& p : partials)
+        result = op.combine(result, p);
+    return result;
+}
+
+// ---------------------------------------------------------------- public API
+
+template <typename T, typename Op>
+typename Op::result_type parallel_reduce(const T* x, size_t n, Op op = Op(), int num_threads = 0) {
+    return run_parallel(n, op, num_threads, [x, &op](size_t begin, size_t end) {
+        if constexpr (simd_kernel<Op, T>::available) {
+            return sliced(begin, end, op, [x](size_t off, int len) {
+                return simd_kernel<Op, T>::run(x + off, len, off);
+            });
+        } else {
+            return generic_chunk(begin, end, op, [x](size_t i) { return x[i]; });
+        }
+    });
+}
+
+// op(f(x[0]), f(x[1]), ...)
+template <typename T, typename F, typename Op>
+typename Op::result_type transform_reduce(const T* x, size_t n, F f, Op op, int num_threads = 0) {
+    return run_parallel(n, op, num_threads, [x, &f, &op](size_t begin, size_t end) {
+        if constexpr (simd_transform_kernel<F, Op, T>::available) {
+            return sliced(begin, end, op, [x](size_t off, int len) {
+                return simd_transform_kernel<F, Op, T>::run(x + off, len);
+            });
+        } else {
+            return generic_chunk(begin, end, op, [x, &f](size_t i) { return f(x[i]); });
+        }
+    });
+}
+
+// op(f(x[0], y[0]), f(x[1], y[1]), ...)
+template <typename T, typename F, typename Op>
+typename Op::result_type transform_reduce(const T* x, const T* y, size_t n, F f, Op op, int num_threads = 0) {
+    return run_parallel(n, op, num_threads, [x, y, &f, &op](size_t begin, size_t end) {
+        if constexpr (simd_binary_kernel<F, Op, T>::available) {
+            return sliced(begin, end, op, [x, y](size_t off, int len) {
+                return simd_binary_kernel<F, Op, T>::run(x + off, y + off, len);
+            });
+        } else {
+            return generic_chunk(begin, end, op, [x, y, &f](size_t i) { return f(x[i], y[i]); });
+        }
+    });
+}
+
+template <typename T>
+T dot(const T* x, const T* y, size_t n, int num_threads = 0) {
+    return transform_reduce(x, y, n, Multiply<T>(), Sum<T>(), num_threads);
+}
+
+template <typename T>
+T norm2(const T* x, size_t n, int num_threads = 0) {
+    return std::sqrt(transform_reduce(x, n, Square<T>(), Sum<T>(), num_threads));
+}
+
+// Index of the first largest element (n must be > 0)
+template <typename T>
+size_t argmax(const T* x, size_t n, int num_threads = 0) {
+    return parallel_reduce(x, n, ArgMax<T>(), num_threads).index;
+}
+
+/*
+    Equal-width histogram of [lo, hi) with `bins` bins; values outside the range
+    are clamped into the first/last bin. Each thread counts into its own bins,
+    which are summed at the end, so no atomics are needed.
+*/
+template <typename T>
+std::vector<size_t> histogram(const T* x, size_t n, int bins, T lo, T hi, int num_threads = 0) {
+    if (num_threads <= 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::vector<size_t>> local(num_threads, std::vector<size_t>(bins, 0));
+    std::vector<std::thread> threads(num_threads);
+    const double scale = bins / (double)(hi - lo);
+
+    size_t chunk_size = n / num_threads;
+    for (int t = 0; t < num_threads; t++) {
+        size_t begin = t * chunk_size;
+        size_t end = (t == num_threads - 1) ? n : begin + chunk_size;
+        threads[t] = std::thread([&local, x, t, begin, end, bins, lo, scale]() {
+            size_t* counts = local[t].data();
+            for (size_t i = begin; i < end; i++) {
+                long b = (long)((x[i] - lo) * scale);
+                b = b < 0 ? 0 : (b >= bins ? bins - 1 : b);
+                counts[b]++;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    std::vector<size_t> counts(bins, 0);
+    for (const auto& l : local)
+        for (int b = 0; b < bins; b++)
+            counts[b] += l[b];
+    return counts;
+}
+
+} // namespace preduce
+
+#endif
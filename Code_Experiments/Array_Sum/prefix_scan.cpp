@@ -0,0 +1,129 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <numeric>
+#include <thread>
+#include <algorithm>
+#include "prefix_scan_ispc.h"
+
+// Serial inclusive scan
+void serial_scan(int N, int* x, int* y) {
+    int sum = 0;
+    for (int i = 0; i < N; i++) {
+        sum += x[i];
+        y[i] = sum;
+    }
+}
+
+/*
+    Two-pass (reduce-then-scan) block scan.
+    Pass 1: every thread sums its block.
+    The block totals are exclusive-scanned serially (one value per thread).
+    Pass 2: every thread scans its block with the ISPC kernel, starting from its offset.
+    The input is read twice but the output is written only once.
+*/
+void parallel_scan(int N, int* x, int* y, bool inclusive, int num_threads) {
+    std::vector<std::thread> threads(num_threads);
+    std::vector<int> block_start(num_threads + 1);
+    std::vector<int> block_total(num_threads);
+
+    int chunk_size = N / num_threads;
+    int remainder = N % num_threads;
+    for (int t = 0; t <= num_threads; t++) {
+        block_start[t] = t * chunk_size + std::min(t, remainder);
+    }
+
+    for (int t = 0; t < num_threads; t++) {
+        threads[t] = std::thread([&, t]() {
+            block_total[t] = ispc::block_sum_ispc(block_start[t + 1] - block_start[t], x + block_start[t]);
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    int carry = 0;
+    for (int t = 0; t < num_threads; t++) {
+        int total = block_total[t];
+        block_total[t] = carry;
+        carry += total;
+    }
+
+    for (int t = 0; t < num_threads; t++) {
+        threads[t] = std::thread([&, t]() {
+            int n = block_start[t + 1] - block_start[t];
+            int offset = block_start[t];
+            if (inclusive)
+                ispc::inclusive_scan_ispc(n, x + offset, y + offset, block_total[t]);
+            else
+                ispc::exclusive_scan_ispc(n, x + offset, y + offset, block_total[t]);
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+template <typename F>
+long long time_us(F f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+int main() {
+    const int N = 100000000; // 100 million elements
+    const int num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Create and fill vector with small random values (e.g. flags or bin counts)
+    std::vector<int> numbers(N);
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dis(0, 3);
+
+    for (int i = 0; i < N; i++) {
+        numbers[i] = dis(gen);
+    }
+
+    std::vector<int> y_serial(N), y_std(N), y_ispc(N), y_parallel(N);
+    std::vector<int> e_std(N), e_parallel(N);
+
+    // Inclusive scans
+    auto serial_time = time_us([&] { serial_scan(N, numbers.data(), y_serial.data()); });
+    auto std_time = time_us([&] { std::inclusive_scan(numbers.begin(), numbers.end(), y_std.begin()); });
+    auto ispc_time = time_us([&] { ispc::inclusive_scan_ispc(N, numbers.data(), y_ispc.data(), 0); });
+    auto parallel_time = time_us([&] { parallel_scan(N, numbers.data(), y_parallel.data(), true, num_threads); });
+
+    // Exclusive scans
+    auto std_ex_time = time_us([&] { std::exclusive_scan(numbers.begin(), numbers.end(), e_std.begin(), 0); });
+    auto parallel_ex_time = time_us([&] { parallel_scan(N, numbers.data(), e_parallel.data(), false, num_threads); });
+
+    bool inclusive_match = y_std == y_serial && y_ispc == y_serial && y_parallel == y_serial;
+    bool exclusive_match = e_parallel == e_std;
+
+    // Print results
+    std::cout << "Array size: " << N << " elements, " << num_threads << " threads\n";
+    std::cout << "\nInclusive scan:\n";
+    std::cout << "Serial loop:          " << serial_time << " microseconds\n";
+    std::cout << "std::inclusive_scan:  " << std_time << " microseconds\n";
+    std::cout << "ISPC (1 thread):      " << ispc_time << " microseconds\n";
+    std::cout << "ISPC + threads:       " << parallel_time << " microseconds\n";
+    std::cout << "Speedup vs std:       " << (float)std_time / ispc_time << "x (ISPC), "
+              << (float)std_time / parallel_time << "x (ISPC + threads)\n";
+    // reduce-then-scan reads the input twice and writes the output once
+    std::cout << "Bandwidth (threads):  " << 3.0 * N * sizeof(int) / parallel_time / 1e3 << " GB/s\n";
+
+    std::cout << "\nExclusive scan:\n";
+    std::cout << "std::exclusive_scan:  " << std_ex_time << " microseconds\n";
+    std::cout << "ISPC + threads:       " << parallel_ex_time << " microseconds\n";
+    std::cout << "Speedup vs std:       " << (float)std_ex_time / parallel_ex_time << "x\n";
+
+    if (inclusive_match && exclusive_match) {
+        std::cout << "\nAll scans produce matching results!\n";
+    } else {
+        std::cout << "\nWARNING: scan results differ!\n";
+    }
+    return 0;
+}
@@ -0,0 +1,247 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <memory>
+#include "array_sum_ispc.h"
+
+using namespace std;
+
+/*
+    Multi-threaded reduction engine on top of the ISPC sum kernels.
+
+    The array is split into one contiguous chunk per thread (as in
+    taylor_parallel), every thread reduces its chunk with the selected mode and
+    the per-thread partials are merged on the main thread with Neumaier
+    summation in double, so the merge itself never adds visible error.
+
+    Each mode is timed (best of a few runs), reported in GB/s next to the
+    machine's measured read bandwidth, and checked against a compensated
+    reference sum. The fastest mode that meets the relative error target wins.
+
+    usage: ./reduction_engine [N] [relative_error_target]
+*/
+
+enum reduce_mode {
+    NAIVE_FLOAT,     // sum_array(): float lanes, what array_sum_vec.cpp measures
+    NAIVE_DOUBLE,    // sum_array_double(): float input, double lanes
+    PAIRWISE_FLOAT,  // recursive halving down to blocks summed by sum_array()
+    KAHAN_FLOAT,     // sum_array_kahan(): compensated float lanes
+    NEUMAIER_FLOAT,  // sum_array_neumaier(): compensated float lanes, robust to large terms
+    KAHAN_DOUBLE,    // sum_array_kahan_double(): compensated double lanes
+    NEUMAIER_DOUBLE, // sum_array_neumaier_double(): compensated double lanes, robust to large terms
+    NUM_MODES
+};
+
+static const char* mode_names[NUM_MODES] = {
+    "naive-float", "naive-double", "pairwise-float", "kahan-float", "neumaier-float",
+    "kahan-double", "neumaier-double"
+};
+
+// Blocks at or below this size are summed directly by the ISPC kernel
+const int PAIRWISE_BLOCK = 4096;
+const int TIMED_RUNS = 3;
+
+// Neumaier summation of a few doubles (used to merge per-thread partials)
+double neumaier_sum(const vector<double>& values) {
+    double sum = 0.0, comp = 0.0;
+    for (double v : values) {
+        double t = sum + v;
+        if (fabs(sum) >= fabs(v))
+            comp += (sum - t) + v;
+        else
+            comp += (v - t) + sum;
+        sum = t;
+    }
+    return sum + comp;
+}
+
+float pairwise_sum(int n, float* x) {
+    if (n <= PAIRWISE_BLOCK)
+        return ispc::sum_array(n, x);
+    int half = n / 2;
+    return pairwise_sum(half, x) + pairwise_sum(n - half, x + half);
+}
+
+double reduce_chunk(reduce_mode mode, int n, float* x) {
+    switch (mode) {
+    case NAIVE_FLOAT:     return ispc::sum_array(n, x);
+    case NAIVE_DOUBLE:    return ispc::sum_array_double(n, x);
+    case PAIRWISE_FLOAT:  return pairwise_sum(n, x);
+    case KAHAN_FLOAT:     return ispc::sum_array_kahan(n, x);
+    case NEUMAIER_FLOAT:  return ispc::sum_array_neumaier(n, x);
+    case KAHAN_DOUBLE:    return ispc::sum_array_kahan_double(n, x);
+    case NEUMAIER_DOUBLE: return ispc::sum_array_neumaier_double(n, x);
+    default:              return 0.0;
+    }
+}
+
+// Function to reduce the whole array with num_threads threads
+double parallel_reduce(reduce_mode mode, size_t n, float* x, int num_threads) {
+    vector<thread> threads(num_threads);
+    vector<double> partials(num_threads, 0.0);
+
+    size_t chunk_size = n / num_threads;
+    size_t remainder = n % num_threads;
+    size_t start_pos = 0;
+    for (int t = 0; t < num_threads; t++) {
+        size_t current_chunk = chunk_size + (t < (int)remainder ? 1 : 0);
+        threads[t] = thread([&partials, mode, t, current_chunk, x, start_pos]() {
+            // The ISPC kernels take an int count, so very large chunks are walked in slices
+            const size_t max_slice = 1u << 30;
+            vector<double> slices;
+            for (size_t off = 0; off < current_chunk; off += max_slice) {
+                size_t len = min(max_slice, current_chunk - off);
+                slices.push_back(reduce_chunk(mode, (int)len, x + start_pos + off));
+            }
+            partials[t] = neumaier_sum(slices);
+        });
+        start_pos += current_chunk;
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    return neumaier_sum(partials);
+}
+
+/*
+    Read bandwidth roof: every thread streams its chunk as 64-bit words.
+    The result is folded into a value that is printed so the loop can't be removed.
+*/
+uint64_t read_bandwidth_pass(size_t n, const float* x, int num_threads) {
+    const uint64_t* words = reinterpret_cast<const uint64_t*>(x);
+    size_t num_words = n / 2;
+    vector<thread> threads(num_threads);
+    vector<uint64_t> partials(num_threads, 0);
+    size_t chunk_size = num_words / num_threads;
+    for (int t = 0; t < num_threads; t++) {
+        size_t begin = t * chunk_size;
+        size_t end = (t == num_threads - 1) ? num_words : begin + chunk_size;
+        threads[t] = thread([&partials, words, t, begin, end]() {
+            uint64_t a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+            size_t i = begin;
+            for (; i + 4 <= end; i += 4) {
+                a0 ^= words[i];
+                a1 ^= words[i + 1];
+                a2 ^= words[i + 2];
+                a3 ^= words[i + 3];
+            }
+            for (; i < end; i++)
+                a0 ^= words[i];
+            partials[t] = a0 ^ a1 ^ a2 ^ a3;
+        });
+    }
+    uint64_t result = 0;
+    for (int t = 0; t < num_threads; t++) {
+        threads[t].join();
+        result ^= partials[t];
+    }
+    return result;
+}
+
+// Fill in parallel so pages are first touched by the threads that later read them
+// (same chunks as parallel_reduce; x must not have been written before)
+void parallel_fill(size_t n, float* x, int num_threads) {
+    vector<thread> threads(num_threads);
+    size_t chunk_size = n / num_threads;
+    size_t remainder = n % num_threads;
+    size_t begin = 0;
+    for (int t = 0; t < num_threads; t++) {
+        size_t end = begin + chunk_size + (t < (int)remainder ? 1 : 0);
+        threads[t] = thread([x, t, begin, end]() {
+            mt19937 gen(12345 + t);
+            uniform_real_distribution<float> dis(0.0f, 1.0f);
+            for (size_t i = begin; i < end; i++)
+                x[i] = dis(gen);
+        });
+        begin = end;
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+// Serial Neumaier sum in long double, the accuracy reference
+long double reference_sum(size_t n, const float* x) {
+    long double sum = 0.0L, comp = 0.0L;
+    for (size_t i = 0; i < n; i++) {
+        long double v = x[i];
+        long double t = sum + v;
+        if (fabsl(sum) >= fabsl(v))
+            comp += (sum - t) + v;
+        else
+            comp += (v - t) + sum;
+        sum = t;
+    }
+    return sum + comp;
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000000; // 100 million elements
+    double target = argc > 2 ? atof(argv[2]) : 1e-7;
+    const int num_threads = max(1u, thread::hardware_concurrency());
+
+    cout << "Array size: " << n << " elements (" << n * sizeof(float) / 1e9 << " GB)\n";
+    cout << "Threads: " << num_threads << ", relative error target: " << target << "\n";
+
+    // new[] leaves the floats uninitialized (a vector would zero every page here on the main thread)
+    unique_ptr<float[]> numbers(new float[n]);
+    parallel_fill(n, numbers.get(), num_threads);
+
+    long double exact = reference_sum(n, numbers.get());
+    double bytes = (double)n * sizeof(float);
+
+    // Measure the bandwidth roof
+    double best_read = 1e30;
+    uint64_t sink = 0;
+    for (int r = 0; r < TIMED_RUNS; r++) {
+        auto start = chrono::high_resolution_clock::now();
+        sink ^= read_bandwidth_pass(n, numbers.get(), num_threads);
+        auto end = chrono::high_resolution_clock::now();
+        best_read = min(best_read, chrono::duration<double>(end - start).count());
+    }
+    double roof = bytes / best_read / 1e9;
+    cout << "Measured read bandwidth: " << roof << " GB/s (checksum " << (sink & 0xff) << ")\n\n";
+
+    cout << left << setw(16) << "Mode" << right << setw(12) << "Time (ms)" << setw(10) << "GB/s"
+         << setw(10) << "% roof" << setw(14) << "Rel. error" << "\n";
+
+    int best_mode = -1;
+    double best_time = 1e30;
+    for (int m = 0; m < NUM_MODES; m++) {
+        reduce_mode mode = (reduce_mode)m;
+        double result = 0.0;
+        double best = 1e30;
+        for (int r = 0; r < TIMED_RUNS; r++) {
+            auto start = chrono::high_resolution_clock::now();
+            result = parallel_reduce(mode, n, numbers.get(), num_threads);
+            auto end = chrono::high_resolution_clock::now();
+            best = min(best, chrono::duration<double>(end - start).count());
+        }
+        double rel_error = fabs((double)((result - exact) / exact));
+        double gbs = bytes / best / 1e9;
+        cout << left << setw(16) << mode_names[m] << right << fixed << setprecision(3)
+             << setw(12) << best * 1000 << setw(10) << gbs << setw(9) << setprecision(1)
+             << 100.0 * gbs / roof << "%" << scientific << setprecision(2) << setw(14) << rel_error
+             << defaultfloat << "\n";
+
+        if (rel_error <= target && best < best_time) {
+            best_time = best;
+            best_mode = m;
+        }
+    }
+
+    cout << "\nReference sum: " << setprecision(17) << (double)exact << "\n";
+    if (best_mode >= 0) {
+        cout << "Fastest mode meeting the target: " << mode_names[best_mode] << "\n";
+    } else {
+        cout << "No mode meets the target, use a looser one\n";
+    }
+    return 0;
+}
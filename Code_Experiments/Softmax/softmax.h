@@ -0,0 +1,143 @@
+#ifndef SOFTMAX_H
+#define SOFTMAX_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include "softmax_ispc.h"
+#include "../common/thread_pool.h"
+
+/*
+    Row softmax over a batch of rows: y[r][i] = exp(x[r][i] - max_r) / sum_j exp(x[r][j] - max_r).
+
+    softmax::forward(x, y, rows, cols, algorithm, pool) runs the kernels from
+    softmax.ispc on a rows x cols row-major batch. Whole rows are handed to the
+    pool, grain rows at a time, so a batch of short rows (e.g. 128 logits per
+    token) is split into work items of about BATCH_BYTES each instead of one
+    per row, and a single huge row stays on one worker. Without a pool the batch
+    runs on the calling thread.
+
+    Algorithm::ThreePass   max pass, exp + sum pass writing y, scale pass over y
+    Algorithm::Online      one pass computing max and sum together (the sum is
+                           rescaled whenever the running max grows), then one
+                           pass writing y; x is read twice and y written once
+    Algorithm::Auto        ThreePass while a row fits in L2 (y is re-read from
+                           cache, and it does one exp per element instead of
+                           two), Online once it does not and the kernel is
+                           bound by memory traffic
+
+    Input is float or bfloat16 (the upper half of a float, as stored by
+    inference frameworks); output is always float. reference() is the naive
+    scalar 3-pass version the kernels are checked against.
+*/
+
+namespace softmax {
+
+// Bytes of input per pool work item
+const size_t BATCH_BYTES = size_t(256) << 10;
+// Rows longer than this (bytes of input) go to the online kernel under Auto
+const size_t ONLINE_ROW_BYTES = size_t(256) << 10;
+
+enum class Algorithm { ThreePass, Online, Auto };
+
+inline const char* algorithm_name(Algorithm a) {
+    switch (a) {
+    case Algorithm::ThreePass: return "3-pass";
+    case Algorithm::Online:    return "online";
+    default:                   return "auto";
+    }
+}
+
+struct bfloat16 {
+    uint16_t bits;
+};
+
+inline float to_float(bfloat16 b) {
+    uint32_t u = (uint32_t)b.bits << 16;
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// Function to round a float to the nearest bfloat16 (ties to even, NaN kept quiet)
+inline bfloat16 to_bfloat16(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    if ((u & 0x7fffffffu) > 0x7f800000u)
+        return bfloat16{ (uint16_t)((u >> 16) | 0x0040u) };
+    u += 0x7fffu + ((u >> 16) & 1u);
+    return bfloat16{ (uint16_t)(u >> 16) };
+}
+
+inline float to_float(float f) { return f; }
+
+// Naive scalar 3-pass softmax of one batch
+template <typename In>
+void reference(const In* x, float* y, size_t rows, size_t cols) {
+    for (size_t r = 0; r < rows; r++) {
+        const In* xr = x + r * cols;
+        float* yr = y + r * cols;
+        float m = -std::numeric_limits<float>::infinity();
+        for (size_t i = 0; i < cols; i++)
+            m = std::max(m, to_float(xr[i]));
+        float sum = 0;
+        for (size_t i = 0; i < cols; i++) {
+            yr[i] = std::exp(to_float(xr[i]) - m);
+            sum += yr[i];
+        }
+        for (size_t i = 0; i < cols; i++)
+            yr[i] /= sum;
+    }
+}
+
+inline Algorithm resolve(Algorithm a, size_t row_bytes) {
+    if (a != Algorithm::Auto)
+        return a;
+    return row_bytes > ONLINE_ROW_BYTES ? Algorithm::Online : Algorithm::ThreePass;
+}
+
+inline void kernel(Algorithm a, int rows, int cols, const float* x, float* y) {
+    if (a == Algorithm::Online)
+        ispc::softmax_rows_online(rows, cols, const_cast<float*>(x), y);
+    else
+        ispc::softmax_rows_three_pass(rows, cols, const_cast<float*>(x), y);
+}
+
+inline void kernel(Algorithm a, int rows, int cols, const bfloat16* x, float* y) {
+    uint16_t* bits = const_cast<uint16_t*>(reinterpret_cast<const uint16_t*>(x));
+    if (a == Algorithm::Online)
+        ispc::softmax_rows_online_bf16(rows, cols, bits, y);
+    else
+        ispc::softmax_rows_three_pass_bf16(rows, cols, bits, y);
+}
+
+// Function to run softmax on every row of a rows x cols batch (cols must fit in an int)
+template <typename In>
+void forward(const In* x, float* y, size_t rows, size_t cols,
+             Algorithm algorithm = Algorithm::Auto, ThreadPool* pool = nullptr) {
+    if (rows == 0 || cols == 0)
+        return;
+    size_t row_bytes = cols * sizeof(In);
+    Algorithm a = resolve(algorithm, row_bytes);
+    // ISPC kernels take an int row count
+    const size_t max_rows = (size_t)std::numeric_limits<int>::max();
+    auto run_rows = [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; r += max_rows) {
+            size_t n = std::min(max_rows, end - r);
+            kernel(a, (int)n, (int)cols, x + r * cols, y + r * cols);
+        }
+    };
+    if (pool == nullptr || pool->size() == 1) {
+        run_rows(0, rows);
+        return;
+    }
+    size_t grain = std::max<size_t>(1, BATCH_BYTES / row_bytes);
+    pool->parallel_for(rows, grain, run_rows);
+}
+
+} // namespace softmax
+
+#endif
@@ -0,0 +1,195 @@
+#include <math.h>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include "softmax.h"
+#include "../common/thread_pool.h"
+#include "../common/numa_buffer.h"
+#include "../common/bench_harness.h"
+
+using namespace std;
+
+/*
+    Accuracy and throughput of softmax.h on inference-style batches.
+
+    The same number of logits (default 16M) is cut into rows of 128, 4096 and
+    1M columns: many short rows (per-token attention scores), medium rows
+    (vocabulary-sized) and a few rows too long for any cache. For each shape:
+        copy pool       memcpy of the same bytes on the pool, the bandwidth roof
+        reference       naive scalar 3-pass loop (softmax::reference)
+        3-pass/online   ISPC kernels on one thread and on the pool
+        bf16            the same kernels reading bfloat16 input
+    GB/s counts one read of the input and one write of the output, so it is
+    directly comparable to the copy row. After the harness table a summary
+    lists rows/s and every run's share of the copy bandwidth of its shape.
+
+    Before timing, every variant is checked against a double-precision softmax
+    on a sample of rows (max absolute error and the largest |row sum - 1|).
+    bf16 rows are compared with the float result of the same rounded input, so
+    the table shows kernel error, not rounding error. "masked" rows hold -inf
+    logits (a leading run and scattered ones), as padded attention rows do.
+
+    usage: ./softmax_bench [total_elements] [--trials N] [--filter TEXT] [--csv FILE] ...
+*/
+
+const size_t DEFAULT_TOTAL = size_t(1) << 24;
+const size_t SHAPES[] = { 128, 4096, size_t(1) << 20 };
+// Rows checked against the double reference per shape
+const size_t CHECK_ROWS = 8;
+
+struct accuracy {
+    double max_abs = 0;
+    double max_sum_error = 0;
+};
+
+// Function to compare y with a double softmax of x on evenly spaced rows
+template <typename In>
+accuracy check(const In* x, const float* y, size_t rows, size_t cols) {
+    accuracy a;
+    vector<double> exact(cols);
+    size_t step = max<size_t>(1, rows / CHECK_ROWS);
+    for (size_t r = 0; r < rows; r += step) {
+        const In* xr = x + r * cols;
+        const float* yr = y + r * cols;
+        double m = -INFINITY, sum = 0, y_sum = 0;
+        for (size_t i = 0; i < cols; i++)
+            m = max(m, (double)softmax::to_float(xr[i]));
+        for (size_t i = 0; i < cols; i++) {
+            exact[i] = exp((double)softmax::to_float(xr[i]) - m);
+            sum += exact[i];
+        }
+        // a NaN output counts as an infinite error (max() would drop it)
+        for (size_t i = 0; i < cols; i++) {
+            double err = fabs(yr[i] - exact[i] / sum);
+            a.max_abs = isnan(err) ? INFINITY : max(a.max_abs, err);
+            y_sum += yr[i];
+        }
+        a.max_sum_error = isnan(y_sum) ? INFINITY : max(a.max_sum_error, fabs(y_sum - 1.0));
+    }
+    return a;
+}
+
+void print_accuracy(const string& name, size_t cols, accuracy a) {
+    cout << left << setw(20) << name << right << setw(10) << cols << scientific << setprecision(2)
+         << setw(12) << a.max_abs << setw(12) << a.max_sum_error << defaultfloat << endl;
+}
+
+int main(int argc, char* argv[]) {
+    bench::Harness harness("softmax", argc, argv);
+    size_t total = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_TOTAL;
+    ThreadPool pool;
+
+    // Logits spread like attention scores: normal(0, 4), a few large outliers
+    NumaBuffer<float> x(total, pool);
+    NumaBuffer<softmax::bfloat16> x_bf16(total, pool);
+    NumaBuffer<float> y(total, pool), y_copy(total, pool);
+    mt19937 gen(42);
+    normal_distribution<float> d(0.0f, 4.0f);
+    uniform_real_distribution<float> u(0.0f, 1.0f);
+    for (size_t i = 0; i < total; i++) {
+        x[i] = u(gen) < 0.001f ? 40.0f + d(gen) : d(gen);
+        x_bf16[i] = softmax::to_bfloat16(x[i]);
+    }
+
+    cout << "Softmax on " << total << " logits, " << pool.size() << " pool threads" << endl;
+    cout << "\n" << left << setw(20) << "accuracy" << right << setw(10) << "cols"
+         << setw(12) << "max abs" << setw(12) << "|sum - 1|" << endl;
+    const softmax::Algorithm algorithms[] = { softmax::Algorithm::ThreePass, softmax::Algorithm::Online };
+    for (size_t cols : SHAPES) {
+        size_t rows = total / cols;
+        if (rows == 0)
+            continue;
+        softmax::reference(x.data(), y.data(), rows, cols);
+        print_accuracy("reference", cols, check(x.data(), y.data(), rows, cols));
+        for (softmax::Algorithm a : algorithms) {
+            softmax::forward(x.data(), y.data(), rows, cols, a, &pool);
+            print_accuracy(softmax::algorithm_name(a), cols, check(x.data(), y.data(), rows, cols));
+            softmax::forward(x_bf16.data(), y.data(), rows, cols, a, &pool);
+            print_accuracy(string(softmax::algorithm_name(a)) + " bf16", cols,
+                           check(x_bf16.data(), y.data(), rows, cols));
+        }
+    }
+
+    // Masked rows (padded attention): a leading quarter of -inf logits, then every 7th one
+    for (size_t cols : SHAPES) {
+        size_t rows = min<size_t>(2, total / cols);
+        if (rows == 0)
+            continue;
+        vector<float> xm(rows * cols), ym(rows * cols);
+        vector<softmax::bfloat16> xm_bf16(rows * cols);
+        for (size_t i = 0; i < rows * cols; i++) {
+            xm[i] = i % cols < cols / 4 || i % 7 == 0 ? -INFINITY : x[i];
+            xm_bf16[i] = softmax::to_bfloat16(xm[i]);
+        }
+        for (softmax::Algorithm a : algorithms) {
+            softmax::forward(xm.data(), ym.data(), rows, cols, a, &pool);
+            print_accuracy(string(softmax::algorithm_name(a)) + " masked", cols,
+                           check(xm.data(), ym.data(), rows, cols));
+            softmax::forward(xm_bf16.data(), ym.data(), rows, cols, a, &pool);
+            print_accuracy(string(softmax::algorithm_name(a)) + " bf16 masked", cols,
+                           check(xm_bf16.data(), ym.data(), rows, cols));
+        }
+    }
+
+    for (size_t cols : SHAPES) {
+        size_t rows = total / cols;
+        if (rows == 0)
+            continue;
+        size_t n = rows * cols;
+        string shape = to_string(rows) + "x" + to_string(cols) + " ";
+        bench::Work work;
+        work.elements = rows;
+        work.bytes = n * (sizeof(float) + sizeof(float));
+        bench::Work work_bf16 = work;
+        work_bf16.bytes = n * (sizeof(softmax::bfloat16) + sizeof(float));
+
+        harness.run(shape + "copy pool", work, [&] {
+            pool.parallel_for(n, softmax::BATCH_BYTES / sizeof(float), [&](size_t begin, size_t end) {
+                memcpy(y_copy.data() + begin, x.data() + begin, (end - begin) * sizeof(float));
+            });
+        });
+        harness.run(shape + "reference", work, [&] {
+            softmax::reference(x.data(), y.data(), rows, cols);
+        });
+        for (softmax::Algorithm a : algorithms) {
+            string name = shape + softmax::algorithm_name(a);
+            harness.run(name, work, [&] {
+                softmax::forward(x.data(), y.data(), rows, cols, a);
+            });
+            harness.run(name + " pool", work, [&] {
+                softmax::forward(x.data(), y.data(), rows, cols, a, &pool);
+            });
+            harness.run(name + " bf16 pool", work_bf16, [&] {
+                softmax::forward(x_bf16.data(), y.data(), rows, cols, a, &pool);
+            });
+        }
+        harness.run(shape + "auto pool", work, [&] {
+            softmax::forward(x.data(), y.data(), rows, cols, softmax::Algorithm::Auto, &pool);
+        });
+    }
+    harness.finish();
+
+    cout << "\n" << left << setw(32) << "summary" << right << setw(14) << "rows/s"
+         << setw(9) << "GB/s" << setw(10) << "of copy" << endl;
+    double copy_gb_per_sec = 0;
+    string copy_shape;
+    for (const bench::Result& r : harness.results()) {
+        string shape = r.name.substr(0, r.name.find(' '));
+        if (r.name.find("copy pool") != string::npos) {
+            copy_gb_per_sec = r.gb_per_sec();
+            copy_shape = shape;
+        } else if (shape != copy_shape) {
+            copy_gb_per_sec = 0;    // copy row filtered out for this shape
+        }
+        cout << left << setw(32) << r.name << right << fixed << setprecision(0)
+             << setw(14) << r.elements_per_sec() << setprecision(1) << setw(9) << r.gb_per_sec()
+             << setw(9) << (copy_gb_per_sec > 0 ? 100 * r.gb_per_sec() / copy_gb_per_sec : 0) << "%"
+             << defaultfloat << endl;
+    }
+    return 0;
+}
@@ -5,6 +5,9 @@
 #include <random>
 #include <chrono>
 #include "taylor_vector_ispc.h"
+#include "../common/thread_pool.h"
+#include "../common/numa_buffer.h"
+#include "../common/ispc_targets.h"
 
 using namespace std;
 
@@ -55,6 +58,11 @@ void sinx(int N , int terms, double* x, double* y)
     }
 }
 
+// sinx_ispc variant for the widest ISPC target the CPU supports
+// (or the one named by ISPC_TARGET=sse4|avx2|avx512)
+ISPC_DECLARE_VARIANTS(void, sinx_ispc, (int N, int terms, double* x, double* y))
+static void (*const sinx_kernel)(int, int, double*, double*) = ISPC_VARIANT(sinx_ispc);
+
 /*
     Why use a struct?
     In C++, threads can only pass a single argument to their entry function. 
@@ -73,18 +81,15 @@ typedef struct{
 void my_thread_fn(taylor_args *t)
 {
     //sinx(t->n, t->terms, t->x, t->y);
-    ispc::sinx_ispc(t->n, t->terms, t->x, t->y);
+    sinx_kernel(t->n, t->terms, t->x, t->y);
 }
 
-// Parallelism with ThreadPool
-void taylor_parallel(int n, int terms, double* x, double* y) {
+// Parallelism with one-shot threads: spawns and joins a fresh set of threads on every call
+void taylor_parallel_spawn(int n, int terms, double* x, double* y) {
     // Get available threads and allow override
     const int available_threads = thread::hardware_concurrency();
     const int num_threads = 2 * available_threads; // You can modify this line to use more threads
     
-    cout << "Running with " << num_threads << " threads (Hardware supports: " 
-         << available_threads << " threads)" << endl;
-    
     vector<thread> thread_pool(num_threads);
     vector<taylor_args> args(num_threads);
 
@@ -117,19 +122,45 @@ void taylor_parallel(int n, int terms, double* x, double* y) {
 }
 
 
+// Elements per work item: big enough to amortize scheduling, small enough to balance
+const int TAYLOR_GRAIN = 1 << 16;
+
+// Parallelism with the persistent work-stealing ThreadPool
+void taylor_parallel(ThreadPool& pool, int n, int terms, double* x, double* y) {
+    pool.parallel_for(n, TAYLOR_GRAIN, [=](size_t begin, size_t end) {
+        sinx_kernel((int)(end - begin), terms, x + begin, y + begin);
+    });
+}
+
 void taylor_serial(int n, int terms, double* x, double* y) {
     sinx(n, terms, x, y);
 }
 
 void taylor_vector(int n, int terms, double* x, double* y) {
-    ispc::sinx_ispc(n, terms, x, y);
+    sinx_kernel(n, terms, x, y);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     int n = 100000000;
     int terms = 10;
+    // pass "pin" to bind each pool worker to its own core,
+    // "thp" or "hugetlb" to back the arrays with huge pages
+    bool pin = false;
+    HugePages huge = HugePages::None;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "pin")
+            pin = true;
+        else if (arg == "thp")
+            huge = HugePages::Transparent;
+        else if (arg == "hugetlb")
+            huge = HugePages::Explicit;
+    }
+    ThreadPool pool(0, pin);
 
-    vector<double> x(n);
+    // The pool workers first-touch the arrays, so each page sits on the
+    // NUMA node of the worker that starts on it (see numa_buffer.h)
+    NumaBuffer<double> x(n, pool, huge);
     // Generate test data
     random_device rd;
     mt19937 gen(rd());
@@ -138,9 +169,9 @@ int main() {
         x[i] = d(gen);
     }
 
-    vector<double> y_serial(n);
-    vector<double> y_vector(n);
-    vector<double> y_parallel(n);
+    NumaBuffer<double> y_serial(n, pool, huge);
+    NumaBuffer<double> y_vector(n, pool, huge);
+    NumaBuffer<double> y_parallel(n, pool, huge);
 
     // Test 1: Serial version
     cout << "\nRunning serial version..." << endl;
@@ -150,7 +181,7 @@ int main() {
     chrono::duration<double> elapsed_serial = end_serial - start_serial;
 
     // Test 2: ISPC Vector-only version
-    cout << "\nRunning vectorized version..." << endl;
+    cout << "\nRunning vectorized version (ISPC target: " << ispc_target_report() << ")..." << endl;
     auto start_vector = chrono::high_resolution_clock::now();
     taylor_vector(n, terms, x.data(), y_vector.data());
     auto end_vector = chrono::high_resolution_clock::now();
@@ -158,11 +189,32 @@ int main() {
 
     // Test 3: Hybrid (Threads + ISPC) version
     cout << "\nRunning hybrid (threads + SIMD) version..." << endl;
+    cout << "Running with " << pool.size() << " pool threads (Hardware supports: "
+         << thread::hardware_concurrency() << " threads" << (pin ? ", pinned" : "")
+         << ", huge pages: " << huge_pages_name(x.huge_pages()) << ")" << endl;
     auto start_parallel = chrono::high_resolution_clock::now();
-    taylor_parallel(n, terms, x.data(), y_parallel.data());
+    taylor_parallel(pool, n, terms, x.data(), y_parallel.data());
     auto end_parallel = chrono::high_resolution_clock::now();
     chrono::duration<double> elapsed_parallel = end_parallel - start_parallel;
 
+    // Test 4: repeated small calls, where thread creation used to dominate
+    const int repeats = 1000;
+    const int small_n = 100000;
+    cout << "\nRunning " << repeats << " hybrid calls on " << small_n << " elements..." << endl;
+    auto start_spawn = chrono::high_resolution_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        taylor_parallel_spawn(small_n, terms, x.data(), y_parallel.data());
+    }
+    auto end_spawn = chrono::high_resolution_clock::now();
+    chrono::duration<double> elapsed_spawn = end_spawn - start_spawn;
+
+    auto start_pool = chrono::high_resolution_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        taylor_parallel(pool, small_n, terms, x.data(), y_parallel.data());
+    }
+    auto end_pool = chrono::high_resolution_clock::now();
+    chrono::duration<double> elapsed_pool = end_pool - start_pool;
+
     // Print results
     cout << "\nPerformance Results:" << endl;
     cout << "Serial version took:    " << elapsed_serial.count() << " seconds" << endl;
@@ -177,6 +229,10 @@ int main() {
     cout << "Vector speedup:         " << vector_speedup << "x" << endl;
     cout << "Hybrid speedup:         " << hybrid_speedup << "x" << endl;
 
+    cout << "\nRepeated calls (" << repeats << "x):" << endl;
+    cout << "Spawn threads per call: " << elapsed_spawn.count() / repeats * 1e6 << " us per call" << endl;
+    cout << "Persistent pool:        " << elapsed_pool.count() / repeats * 1e6 << " us per call" << endl;
+
     // Verify results
     cout << "\nVerifying results..." << endl;
     bool results_match = true;
@@ -0,0 +1,204 @@
+#include <math.h>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <cstdlib>
+#include "vector_math_ispc.h"
+#include "../common/thread_pool.h"
+
+using namespace std;
+
+/*
+    Accuracy and throughput of the vector_math.ispc functions against libm.
+
+    Inputs are the taylor_parallel.cpp ones: 100M samples of normal(pi, 1)
+    (|x| for log). Every function is timed as
+        libm      - scalar loop calling sin(), expf(), ...
+        ISPC      - one thread
+        ISPC + pool - ThreadPool::parallel_for over the ISPC kernel
+    and its error is measured in ulps against the long double libm result on
+    every ULP_STRIDE-th element (libm is measured the same way, for reference).
+    vsincos/vsincosf run on the same inputs as sin/cos, and both of their
+    outputs are checked.
+
+    usage: ./vector_math_bench [num_elements]
+*/
+
+// Elements per pool work item, as in taylor_parallel
+const int VECTOR_GRAIN = 1 << 16;
+// Every ULP_STRIDE-th element is checked against the long double reference
+const int ULP_STRIDE = 97;
+
+template <typename T>
+struct math_function {
+    const char* name;
+    T (*libm)(T);
+    void (*vec)(int, T*, T*);
+    long double (*reference)(long double);
+};
+
+template <typename F>
+double time_sec(F f) {
+    auto start = chrono::high_resolution_clock::now();
+    f();
+    auto end = chrono::high_resolution_clock::now();
+    return chrono::duration<double>(end - start).count();
+}
+
+// Distance from the exact result in units in the last place of T
+template <typename T>
+double ulp_error(T value, long double exact) {
+    if (isnan(exact))
+        return isnan(value) ? 0 : numeric_limits<double>::infinity();
+    if (isinf(exact) || isinf(value))
+        return value == exact ? 0 : numeric_limits<double>::infinity();
+    int e = exact == 0 ? numeric_limits<T>::min_exponent - 1 : ilogbl(exact);
+    e = max(e, numeric_limits<T>::min_exponent - 1);
+    long double ulp = ldexpl(1.0L, e - (numeric_limits<T>::digits - 1));
+    return (double)(fabsl((long double)value - exact) / ulp);
+}
+
+struct ulp_stats {
+    double max = 0;
+    double mean = 0;
+};
+
+template <typename T>
+ulp_stats measure_ulp(size_t n, const T* x, const T* y, long double (*reference)(long double)) {
+    ulp_stats s;
+    size_t count = 0;
+    for (size_t i = 0; i < n; i += ULP_STRIDE) {
+        double e = ulp_error(y[i], reference((long double)x[i]));
+        s.max = max(s.max, e);
+        s.mean += e;
+        count++;
+    }
+    s.mean /= count;
+    return s;
+}
+
+template <typename T>
+void run_benchmark(ThreadPool& pool, const math_function<T>& f, size_t n, T* x, T* y_libm, T* y_vec) {
+    double libm_time = time_sec([&] {
+        for (size_t i = 0; i < n; i++)
+            y_libm[i] = f.libm(x[i]);
+    });
+    double vec_time = time_sec([&] { f.vec((int)n, x, y_vec); });
+    ulp_stats libm_ulp = measure_ulp(n, x, y_libm, f.reference);
+    ulp_stats vec_ulp = measure_ulp(n, x, y_vec, f.reference);
+    double pool_time = time_sec([&] {
+        pool.parallel_for(n, VECTOR_GRAIN, [&](size_t begin, size_t end) {
+            f.vec((int)(end - begin), x + begin, y_vec + begin);
+        });
+    });
+
+    cout << left << setw(8) << f.name << right << fixed << setprecision(1)
+         << setw(10) << n / libm_time / 1e6
+         << setw(10) << n / vec_time / 1e6
+         << setw(12) << n / pool_time / 1e6
+         << setw(9) << setprecision(2) << libm_time / vec_time << "x"
+         << setw(9) << libm_time / pool_time << "x"
+         << setw(10) << setprecision(3) << libm_ulp.max
+         << setw(10) << vec_ulp.max
+         << setw(10) << vec_ulp.mean << endl;
+}
+
+void print_header(const char* title) {
+    cout << "\n" << title << endl;
+    cout << left << setw(8) << "func" << right
+         << setw(10) << "libm" << setw(10) << "ISPC" << setw(12) << "ISPC+pool"
+         << setw(10) << "speedup" << setw(10) << "(pool)"
+         << setw(10) << "libm ulp" << setw(10) << "max ulp" << setw(10) << "mean ulp" << endl;
+    cout << left << setw(8) << "" << right
+         << setw(10) << "Melem/s" << setw(10) << "Melem/s" << setw(12) << "Melem/s" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000000;
+    if (n > (size_t)numeric_limits<int>::max()) {
+        cerr << "num_elements must fit in an int (ISPC kernels take an int count)" << endl;
+        return 1;
+    }
+    ThreadPool pool;
+
+    // Same test data as taylor_parallel
+    vector<double> x(n);
+    random_device rd;
+    mt19937 gen(rd());
+    normal_distribution<> d(M_PI, 1);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = d(gen);
+    }
+    vector<float> xf(x.begin(), x.end());
+
+    vector<double> y_libm(n), y_vec(n);
+    vector<float> yf_libm(n), yf_vec(n);
+
+    cout << "Vector math vs libm on " << n << " normal(pi, 1) inputs, "
+         << pool.size() << " pool threads" << endl;
+
+    const math_function<double> double_functions[] = {
+        { "sin", [](double v) { return sin(v); }, ispc::vsin, [](long double v) { return sinl(v); } },
+        { "cos", [](double v) { return cos(v); }, ispc::vcos, [](long double v) { return cosl(v); } },
+        { "exp", [](double v) { return exp(v); }, ispc::vexp, [](long double v) { return expl(v); } },
+        { "log", [](double v) { return log(v); }, ispc::vlog, [](long double v) { return logl(v); } },
+    };
+    const math_function<float> float_functions[] = {
+        { "sinf", [](float v) { return sinf(v); }, ispc::vsinf, [](long double v) { return sinl(v); } },
+        { "cosf", [](float v) { return cosf(v); }, ispc::vcosf, [](long double v) { return cosl(v); } },
+        { "expf", [](float v) { return expf(v); }, ispc::vexpf, [](long double v) { return expl(v); } },
+        { "logf", [](float v) { return logf(v); }, ispc::vlogf, [](long double v) { return logl(v); } },
+    };
+
+    print_header("double:");
+    for (const auto& f : double_functions) {
+        // log is only defined for positive inputs, the normal(pi, 1) tail can go below 0,
+        // so it runs on |x| in a copy and the other functions keep the original inputs
+        if (string(f.name) == "log") {
+            vector<double> x_abs(n);
+            for (size_t i = 0; i < n; i++)
+                x_abs[i] = fabs(x[i]);
+            run_benchmark(pool, f, n, x_abs.data(), y_libm.data(), y_vec.data());
+        } else {
+            run_benchmark(pool, f, n, x.data(), y_libm.data(), y_vec.data());
+        }
+    }
+
+    print_header("float:");
+    for (const auto& f : float_functions) {
+        if (string(f.name) == "logf") {
+            vector<float> xf_abs(n);
+            for (size_t i = 0; i < n; i++)
+                xf_abs[i] = fabsf(xf[i]);
+            run_benchmark(pool, f, n, xf_abs.data(), yf_libm.data(), yf_vec.data());
+        } else {
+            run_benchmark(pool, f, n, xf.data(), yf_libm.data(), yf_vec.data());
+        }
+    }
+
+    // sincos shares the range reduction between both results
+    double sincos_libm = time_sec([&] {
+        for (size_t i = 0; i < n; i++) {
+            y_libm[i] = sin(x[i]);
+            y_vec[i] = cos(x[i]);
+        }
+    });
+    double sincos_vec = time_sec([&] { ispc::vsincos((int)n, x.data(), y_libm.data(), y_vec.data()); });
+    double sincosf_vec = time_sec([&] { ispc::vsincosf((int)n, xf.data(), yf_libm.data(), yf_vec.data()); });
+    // both outputs are checked, so vsincos can't drift away from vsin/vcos unnoticed
+    ulp_stats sin_ulp = measure_ulp(n, x.data(), y_libm.data(), [](long double v) { return sinl(v); });
+    ulp_stats cos_ulp = measure_ulp(n, x.data(), y_vec.data(), [](long double v) { return cosl(v); });
+    ulp_stats sinf_ulp = measure_ulp(n, xf.data(), yf_libm.data(), [](long double v) { return sinl(v); });
+    ulp_stats cosf_ulp = measure_ulp(n, xf.data(), yf_vec.data(), [](long double v) { return cosl(v); });
+    cout << "\nsincos:  libm sin+cos " << setprecision(1) << n / sincos_libm / 1e6 << " Melem/s, "
+         << "ISPC vsincos " << n / sincos_vec / 1e6 << " Melem/s, "
+         << "ISPC vsincosf " << n / sincosf_vec / 1e6 << " Melem/s" << endl;
+    cout << "         max ulp vsincos sin " << setprecision(3) << sin_ulp.max << " cos " << cos_ulp.max
+         << ", vsincosf sin " << sinf_ulp.max << " cos " << cosf_ulp.max << endl;
+
+    return 0;
+}
@@ -0,0 +1,359 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+    Shared benchmark harness.
+
+    bench::Harness h("suite", argc, argv);
+    h.run("kernel", bench::Work{ elements, bytes, flops }, [&] { kernel(...); });
+    h.finish();
+
+    Every run() does `warmup` untimed calls and then `trials` timed calls and
+    reports min / median / mean / stddev of the trial times. Throughput
+    (elements/s, GB/s, GFLOP/s) is computed from the median, which is more
+    stable than the min across runs. Work counts are per call and are whatever
+    the kernel is expected to move/compute; pass 0 to leave a column out.
+
+    With --counters, cycles, instructions and last-level cache misses are read
+    through perf_event_open() around the timed trials. The counters follow the
+    calling thread only, so for pooled kernels they cover worker 0's share.
+    If perf is not available (perf_event_paranoid, containers) the columns
+    are left empty.
+
+    Command line options (consumed by the constructor, others are left alone):
+        --warmup N      untimed calls before measuring (default 2)
+        --trials N      timed calls (default 10)
+        --counters      read hardware counters
+        --filter TEXT   only run benchmarks whose name contains TEXT
+        --label TEXT    tag written to every output row (e.g. a commit hash)
+        --csv FILE      append results to FILE (header written when FILE is new)
+        --json FILE     write results to FILE
+*/
+
+namespace bench {
+
+// Work done by one call of the benchmarked function
+struct Work {
+    double elements = 0;
+    double bytes = 0;
+    double flops = 0;
+};
+
+struct Result {
+    std::string name;
+    Work work;
+    int trials = 0;
+    double min = 0, median = 0, mean = 0, stddev = 0;   // seconds per call
+    bool has_counters = false;
+    double cycles = 0, instructions = 0, cache_misses = 0;  // per call
+
+    double elements_per_sec() const { return work.elements / median; }
+    double gb_per_sec() const { return work.bytes / median / 1e9; }
+    double gflops() const { return work.flops / median / 1e9; }
+    double ipc() const { return cycles > 0 ? instructions / cycles : 0; }
+};
+
+// Keep the compiler from discarding a result that is otherwise unused
+template <typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    volatile const T* sink = &value;
+    (void)sink;
+#endif
+}
+
+// cycles, instructions and LLC misses of the calling thread
+class PerfCounters {
+public:
+    PerfCounters() {
+#ifdef __linux__
+        const uint64_t configs[NUM_EVENTS] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES
+        };
+        for (int e = 0; e < NUM_EVENTS; e++) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[e];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds_[e] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            if (fds_[e] < 0)
+                available_ = false;
+        }
+#else
+        available_ = false;
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds_)
+            if (fd >= 0)
+                close(fd);
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const { return available_; }
+
+    void start() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // Function to stop counting and return cycles, instructions, cache misses
+    void stop(double& cycles, double& instructions, double& cache_misses) {
+        double values[NUM_EVENTS] = { 0, 0, 0 };
+#ifdef __linux__
+        for (int e = 0; e < NUM_EVENTS; e++) {
+            ioctl(fds_[e], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t count = 0;
+            if (read(fds_[e], &count, sizeof(count)) == (ssize_t)sizeof(count))
+                values[e] = (double)count;
+        }
+#endif
+        cycles = values[0];
+        instructions = values[1];
+        cache_misses = values[2];
+    }
+
+private:
+    static const int NUM_EVENTS = 3;
+    int fds_[NUM_EVENTS] = { -1, -1, -1 };
+    bool available_ = true;
+};
+
+class Harness {
+public:
+    Harness(const std::string& suite, int& argc, char** argv) : suite_(suite) {
+        int kept = 1;
+        for (int a = 1; a < argc; a++) {
+            std::string arg = argv[a];
+            bool has_value = a + 1 < argc;
+            if (arg == "--warmup" && has_value)
+                warmup_ = std::max(0, atoi(argv[++a]));
+            else if (arg == "--trials" && has_value)
+                trials_ = std::max(1, atoi(argv[++a]));
+            else if (arg == "--filter" && has_value)
+                filter_ = argv[++a];
+            else if (arg == "--label" && has_value)
+                label_ = argv[++a];
+            else if (arg == "--csv" && has_value)
+                csv_path_ = argv[++a];
+            else if (arg == "--json" && has_value)
+                json_path_ = argv[++a];
+            else if (arg == "--counters")
+                use_counters_ = true;
+            else
+                argv[kept++] = argv[a];
+        }
+        argc = kept;
+
+        if (use_counters_) {
+            counters_.reset(new PerfCounters());
+            if (!counters_->available()) {
+                std::cerr << "perf_event_open failed, running without hardware counters" << std::endl;
+                counters_.reset();
+            }
+        }
+    }
+
+    Harness(const Harness&) = delete;
+    Harness& operator=(const Harness&) = delete;
+
+    // Function to benchmark f(); returns nullptr when the name is filtered out
+    template <typename F>
+    const Result* run(const std::string& name, Work work, F f) {
+        if (!filter_.empty() && name.find(filter_) == std::string::npos)
+            return nullptr;
+        if (results_.empty())
+            print_header();
+
+        for (int w = 0; w < warmup_; w++)
+            f();
+
+        Result r;
+        r.name = name;
+        r.work = work;
+        r.trials = trials_;
+        std::vector<double> times(trials_);
+        if (counters_)
+            counters_->start();
+        for (int t = 0; t < trials_; t++) {
+            auto start = std::chrono::steady_clock::now();
+            f();
+            auto end = std::chrono::steady_clock::now();
+            times[t] = std::chrono::duration<double>(end - start).count();
+        }
+        if (counters_) {
+            counters_->stop(r.cycles, r.instructions, r.cache_misses);
+            r.cycles /= trials_;
+            r.instructions /= trials_;
+            r.cache_misses /= trials_;
+            r.has_counters = true;
+        }
+
+        std::sort(times.begin(), times.end());
+        r.min = times[0];
+        r.median = trials_ % 2 ? times[trials_ / 2] : 0.5 * (times[trials_ / 2 - 1] + times[trials_ / 2]);
+        double sum = 0;
+        for (double t : times)
+            sum += t;
+        r.mean = sum / trials_;
+        double var = 0;
+        for (double t : times)
+            var += (t - r.mean) * (t - r.mean);
+        r.stddev = trials_ > 1 ? std::sqrt(var / (trials_ - 1)) : 0;
+
+        results_.push_back(r);
+        print_row(r);
+        return &results_.back();
+    }
+
+    // Function to write the CSV/JSON files requested on the command line
+    void finish() {
+        if (!csv_path_.empty())
+            write_csv();
+        if (!json_path_.empty())
+            write_json();
+    }
+
+    const std::deque<Result>& results() const { return results_; }
+
+private:
+    void print_header() const {
+        std::cout << "\n" << suite_ << " (" << warmup_ << " warmup, " << trials_ << " trials)" << std::endl;
+        std::cout << std::left << std::setw(28) << "benchmark" << std::right
+                  << std::setw(11) << "median ms" << std::setw(11) << "min ms" << std::setw(9) << "stddev"
+                  << std::setw(11) << "Gelem/s" << std::setw(9) << "GB/s" << std::setw(9) << "GFLOP/s";
+        if (counters_)
+            std::cout << std::setw(7) << "IPC" << std::setw(14) << "LLC miss/call";
+        std::cout << std::endl;
+    }
+
+    void print_row(const Result& r) const {
+        std::cout << std::left << std::setw(28) << r.name << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(11) << r.median * 1e3 << std::setw(11) << r.min * 1e3
+                  << std::setw(8) << std::setprecision(1) << (r.mean > 0 ? 100 * r.stddev / r.mean : 0) << "%"
+                  << std::setprecision(3) << std::setw(11) << r.elements_per_sec() / 1e9
+                  << std::setprecision(1) << std::setw(9) << r.gb_per_sec() << std::setw(9) << r.gflops();
+        if (r.has_counters)
+            std::cout << std::setprecision(2) << std::setw(7) << r.ipc()
+                      << std::setprecision(0) << std::setw(14) << r.cache_misses;
+        std::cout << std::defaultfloat << std::endl;
+    }
+
+    static std::string escape(const std::string& s) {
+        std::string out;
+        for (char c : s) {
+            if (c == '"' || c == '\\')
+                out += '\\';
+            out += c;
+        }
+        return out;
+    }
+
+    // CSV field: quoted, embedded quotes doubled (RFC 4180), so commas stay in one column
+    static std::string csv_quote(const std::string& s) {
+        std::string out = "\"";
+        for (char c : s) {
+            if (c == '"')
+                out += '"';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    void write_csv() const {
+        FILE* existing = fopen(csv_path_.c_str(), "r");
+        bool is_new = existing == nullptr || fgetc(existing) == EOF;
+        if (existing)
+            fclose(existing);
+
+        FILE* f = fopen(csv_path_.c_str(), "a");
+        if (f == nullptr) {
+            std::cerr << "Error: Could not open " << csv_path_ << " for writing" << std::endl;
+            return;
+        }
+        if (is_new)
+            fprintf(f, "label,suite,name,trials,min_s,median_s,mean_s,stddev_s,"
+                       "elements_per_s,gb_per_s,gflop_per_s,cycles,instructions,ipc,cache_misses\n");
+        for (const Result& r : results_) {
+            fprintf(f, "%s,%s,%s,%d,%.9g,%.9g,%.9g,%.9g,%.6g,%.6g,%.6g,",
+                    csv_quote(label_).c_str(), csv_quote(suite_).c_str(), csv_quote(r.name).c_str(), r.trials, r.min, r.median, r.mean,
+                    r.stddev, r.elements_per_sec(), r.gb_per_sec(), r.gflops());
+            if (r.has_counters)
+                fprintf(f, "%.0f,%.0f,%.4f,%.0f\n", r.cycles, r.instructions, r.ipc(), r.cache_misses);
+            else
+                fprintf(f, ",,,\n");
+        }
+        fclose(f);
+    }
+
+    void write_json() const {
+        FILE* f = fopen(json_path_.c_str(), "w");
+        if (f == nullptr) {
+            std::cerr << "Error: Could not open " << json_path_ << " for writing" << std::endl;
+            return;
+        }
+        fprintf(f, "{\n  \"suite\": \"%s\",\n  \"label\": \"%s\",\n  \"warmup\": %d,\n  \"results\": [\n",
+                escape(suite_).c_str(), escape(label_).c_str(), warmup_);
+        for (size_t i = 0; i < results_.size(); i++) {
+            const Result& r = results_[i];
+            fprintf(f, "    { \"name\": \"%s\", \"trials\": %d, \"min_s\": %.9g, \"median_s\": %.9g, "
+                       "\"mean_s\": %.9g, \"stddev_s\": %.9g, \"elements_per_s\": %.6g, "
+                       "\"gb_per_s\": %.6g, \"gflop_per_s\": %.6g",
+                    escape(r.name).c_str(), r.trials, r.min, r.median, r.mean, r.stddev,
+                    r.elements_per_sec(), r.gb_per_sec(), r.gflops());
+            if (r.has_counters)
+                fprintf(f, ", \"cycles\": %.0f, \"instructions\": %.0f, \"ipc\": %.4f, \"cache_misses\": %.0f",
+                        r.cycles, r.instructions, r.ipc(), r.cache_misses);
+            fprintf(f, " }%s\n", i + 1 < results_.size() ? "," : "");
+        }
+        fprintf(f, "  ]\n}\n");
+        fclose(f);
+    }
+
+    std::string suite_;
+    std::string filter_, label_, csv_path_, json_path_;
+    int warmup_ = 2;
+    int trials_ = 10;
+    bool use_counters_ = false;
+    std::unique_ptr<PerfCounters> counters_;
+    std::deque<Result> results_;    // deque: run() hands out pointers into it
+};
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef ISPC_TARGETS_H
+#define ISPC_TARGETS_H
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <iostream>
+
+/*
+    Runtime choice between ISPC target variants (x86).
+
+    Built with several targets,
+        ispc -O2 --target=sse4-i32x4,avx2-i32x8,avx512skx-x16 foo.ispc -o foo_ispc.o -h foo_ispc.h
+    ispc writes one object per target (foo_ispc_sse4.o, foo_ispc_avx2.o,
+    foo_ispc_avx512skx.o) whose exported functions carry the ISA as a suffix
+    (sum_array_avx2, ...), plus foo_ispc.o with wrappers under the plain names
+    that jump to the widest variant the CPU supports. Link all of them and
+    compile with -DISPC_MULTI_TARGET.
+
+    The wrappers can't be overridden or asked which variant they picked, so
+    kernels we benchmark declare their variants with ISPC_DECLARE_VARIANTS and
+    are called through ISPC_VARIANT(name), which follows select_ispc_target():
+    the widest supported target, or the one named in the ISPC_TARGET
+    environment variable (sse4, avx2, avx512) when the CPU supports it.
+
+    Without ISPC_MULTI_TARGET (a single --target build) ISPC_VARIANT(name) is
+    just ispc::name.
+*/
+
+enum class IspcTarget { SSE4, AVX2, AVX512 };
+
+inline const char* ispc_target_name(IspcTarget t) {
+    switch (t) {
+    case IspcTarget::AVX512: return "avx512";
+    case IspcTarget::AVX2: return "avx2";
+    default: return "sse4";
+    }
+}
+
+// Instruction sets each ispc target is compiled against
+inline bool cpu_supports(IspcTarget t) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    switch (t) {
+    case IspcTarget::AVX512:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd") &&
+               __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq") &&
+               __builtin_cpu_supports("avx512vl");
+    case IspcTarget::AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    default:
+        return __builtin_cpu_supports("sse4.2");
+    }
+#else
+    (void)t;
+    return false;
+#endif
+}
+
+inline IspcTarget widest_ispc_target() {
+    if (cpu_supports(IspcTarget::AVX512))
+        return IspcTarget::AVX512;
+    if (cpu_supports(IspcTarget::AVX2))
+        return IspcTarget::AVX2;
+    return IspcTarget::SSE4;
+}
+
+// Widest supported target unless ISPC_TARGET asks for a (supported) narrower one
+inline IspcTarget select_ispc_target() {
+    static const IspcTarget chosen = []() {
+        IspcTarget widest = widest_ispc_target();
+        const char* requested = getenv("ISPC_TARGET");
+        if (requested == nullptr || *requested == '\0')
+            return widest;
+        for (IspcTarget t : { IspcTarget::SSE4, IspcTarget::AVX2, IspcTarget::AVX512 }) {
+            if (strcmp(requested, ispc_target_name(t)) != 0)
+                continue;
+            if (cpu_supports(t))
+                return t;
+            std::cerr << "ISPC_TARGET=" << requested << " is not supported by this CPU, using "
+                      << ispc_target_name(widest) << std::endl;
+            return widest;
+        }
+        std::cerr << "Unknown ISPC_TARGET=" << requested << " (sse4, avx2, avx512), using "
+                  << ispc_target_name(widest) << std::endl;
+        return widest;
+    }();
+    return chosen;
+}
+
+template <typename F>
+F ispc_variant(F sse4, F avx2, F avx512) {
+    switch (select_ispc_target()) {
+    case IspcTarget::AVX512: return avx512;
+    case IspcTarget::AVX2: return avx2;
+    default: return sse4;
+    }
+}
+
+// One line for the benchmark output: which variant runs and why
+inline std::string ispc_target_report() {
+#ifdef ISPC_MULTI_TARGET
+    std::string report = ispc_target_name(select_ispc_target());
+    if (select_ispc_target() != widest_ispc_target())
+        report += std::string(" (forced by ISPC_TARGET, widest supported: ") +
+                  ispc_target_name(widest_ispc_target()) + ")";
+    else
+        report += " (widest supported)";
+    return report;
+#else
+    return "single target build";
+#endif
+}
+
+#ifdef ISPC_MULTI_TARGET
+#define ISPC_DECLARE_VARIANTS(ret, name, params) \
+    extern "C" ret name##_sse4 params;           \
+    extern "C" ret name##_avx2 params;           \
+    extern "C" ret name##_avx512skx params;
+#define ISPC_VARIANT(name) ispc_variant(name##_sse4, name##_avx2, name##_avx512skx)
+#else
+#define ISPC_DECLARE_VARIANTS(ret, name, params)
+#define ISPC_VARIANT(name) ispc::name
+#endif
+
+#endif
@@ -0,0 +1,142 @@
+#include <math.h>
+#include <iostream>
+#include <vector>
+#include <random>
+#include <string>
+#include <mutex>
+#include "array_sum_ispc.h"
+#include "taylor_vector_ispc.h"
+#include "vector_math_ispc.h"
+#include "../../MPI/mandel_kernels.h"
+#include "thread_pool.h"
+#include "bench_harness.h"
+
+using namespace std;
+
+/*
+    Regression benchmark for the core kernels, built on bench_harness.h:
+        sum_array      (Array_Sum/array_sum.ispc)      10M floats
+        sinx_ispc      (Taylor_Approximation)          10M doubles, 10 terms
+        vsin           (Taylor_Approximation/vector_math.ispc)
+        mandel         (MPI/mandel_kernels.h)          1600x1200 full view
+    each single-threaded and on the ThreadPool where it makes sense.
+
+    usage: ./kernel_bench [--trials N] [--warmup N] [--counters] [--filter TEXT]
+                          [--label TEXT] [--csv FILE] [--json FILE]
+*/
+
+const int SUM_N = 10000000;
+const int TAYLOR_N = 10000000;
+const int TAYLOR_TERMS = 10;
+const size_t GRAIN = 1 << 16;
+const int MANDEL_WIDTH = 1600;
+const int MANDEL_HEIGHT = 1200;
+const int MANDEL_ITERATIONS = 256;
+
+// Serial sum, same loop as array_sum_vec.cpp
+float serial_sum(int N, const float* array) {
+    float sum = 0;
+    for (int i = 0; i < N; i++) {
+        sum += array[i];
+    }
+    return sum;
+}
+
+// Function to render the mandelbrot.c view with a rows kernel, 16 rows per call
+void render(rows_kernel kernel, int* output) {
+    const float x0 = -2.0f, x1 = 1.0f, y0 = -1.0f, y1 = 1.0f;
+    float dx = (x1 - x0) / MANDEL_WIDTH;
+    float dy = (y1 - y0) / MANDEL_HEIGHT;
+    for (int j = 0; j < MANDEL_HEIGHT; j += 16) {
+        int rows = min(16, MANDEL_HEIGHT - j);
+        kernel(x0, y0, dx, dy, j, rows, MANDEL_WIDTH, MANDEL_ITERATIONS, output + (size_t)j * MANDEL_WIDTH);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bench::Harness harness("kernels", argc, argv);
+    ThreadPool pool;
+
+    mt19937 gen(42);
+
+    // ---------------- sum_array
+    vector<float> numbers(SUM_N);
+    uniform_real_distribution<float> dis(0.0f, 1.0f);
+    for (int i = 0; i < SUM_N; i++) {
+        numbers[i] = dis(gen);
+    }
+    bench::Work sum_work;
+    sum_work.elements = SUM_N;
+    sum_work.bytes = SUM_N * sizeof(float);
+    sum_work.flops = SUM_N;
+
+    harness.run("sum serial", sum_work, [&] {
+        bench::do_not_optimize(serial_sum(SUM_N, numbers.data()));
+    });
+    harness.run("sum_array", sum_work, [&] {
+        bench::do_not_optimize(ispc::sum_array(SUM_N, numbers.data()));
+    });
+    harness.run("sum_array pool", sum_work, [&] {
+        mutex sum_mutex;
+        float sum = 0;
+        pool.parallel_for(SUM_N, GRAIN, [&](size_t begin, size_t end) {
+            float partial = ispc::sum_array((int)(end - begin), numbers.data() + begin);
+            lock_guard<mutex> lock(sum_mutex);
+            sum += partial;
+        });
+        bench::do_not_optimize(sum);
+    });
+
+    // ---------------- sinx_ispc / vsin, taylor_parallel inputs
+    vector<double> x(TAYLOR_N), y(TAYLOR_N);
+    normal_distribution<> d(M_PI, 1);
+    for (int i = 0; i < TAYLOR_N; i++) {
+        x[i] = d(gen);
+    }
+    bench::Work taylor_work;
+    taylor_work.elements = TAYLOR_N;
+    taylor_work.bytes = 2.0 * TAYLOR_N * sizeof(double);
+    // per term: sign * numerator / denominator, the add, numerator and denominator updates
+    taylor_work.flops = (double)TAYLOR_N * (2 + 8 * TAYLOR_TERMS);
+
+    harness.run("sinx_ispc", taylor_work, [&] {
+        ispc::sinx_ispc(TAYLOR_N, TAYLOR_TERMS, x.data(), y.data());
+    });
+    harness.run("sinx_ispc pool", taylor_work, [&] {
+        pool.parallel_for(TAYLOR_N, GRAIN, [&](size_t begin, size_t end) {
+            ispc::sinx_ispc((int)(end - begin), TAYLOR_TERMS, x.data() + begin, y.data() + begin);
+        });
+    });
+
+    bench::Work vsin_work;
+    vsin_work.elements = TAYLOR_N;
+    vsin_work.bytes = 2.0 * TAYLOR_N * sizeof(double);
+    harness.run("vsin", vsin_work, [&] { ispc::vsin(TAYLOR_N, x.data(), y.data()); });
+    harness.run("vsin pool", vsin_work, [&] {
+        pool.parallel_for(TAYLOR_N, GRAIN, [&](size_t begin, size_t end) {
+            ispc::vsin((int)(end - begin), x.data() + begin, y.data() + begin);
+        });
+    });
+
+    // ---------------- mandel
+    vector<int> image((size_t)MANDEL_WIDTH * MANDEL_HEIGHT);
+    render(mandelRows, image.data());
+    double iterations = 0;
+    for (int v : image)
+        iterations += v;
+    bench::Work mandel_work;
+    mandel_work.elements = (double)MANDEL_WIDTH * MANDEL_HEIGHT;
+    mandel_work.bytes = mandel_work.elements * sizeof(int);
+    // about 10 flops per scalar iteration (|z|^2 test and update); the fast kernel
+    // skips iterations, so it shows up as a higher effective rate
+    mandel_work.flops = iterations * 10;
+
+    harness.run("mandel scalar", mandel_work, [&] { render(mandelRows, image.data()); });
+    harness.run("mandel fast", mandel_work, [&] { render(mandelRowsFast, image.data()); });
+#ifdef USE_ISPC
+    harness.run("mandel ispc", mandel_work, [&] { render(mandelRowsISPC, image.data()); });
+#endif
+
+    harness.finish();
+    return 0;
+}
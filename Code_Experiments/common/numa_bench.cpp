@@ -0,0 +1,140 @@
+#include <math.h>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <mutex>
+#include <algorithm>
+#include <cstdlib>
+#include "taylor_vector_ispc.h"
+#include "array_sum_ispc.h"
+#include "thread_pool.h"
+#include "numa_buffer.h"
+
+using namespace std;
+
+/*
+    Effect of page placement on the 100M-element experiments.
+
+    The same two kernels run on buffers allocated four ways:
+        std::vector                 zeroed (first-touched) by the main thread
+        NumaBuffer, none            first-touched by the pool workers, 4 KB pages
+        NumaBuffer, transparent     same, with transparent huge pages
+        NumaBuffer, explicit        same, with MAP_HUGETLB pages (if any are reserved)
+    Kernels: taylor_parallel (sinx_ispc, 10 terms, on the pool) and a pooled
+    sum_array over a float array. Each is timed TRIALS times and the best run is
+    reported.
+
+    On a single-socket machine only the huge-page rows should differ; on a
+    multi-socket machine the std::vector row is limited to one socket's memory
+    bandwidth. Run with "pin" so workers stay on the node they touched.
+
+    usage: ./numa_bench [num_elements] [pin]
+*/
+
+const int TRIALS = 5;
+const int TERMS = 10;
+const size_t GRAIN = 1 << 16;
+
+struct bench_result {
+    double alloc_time;
+    double taylor_time;
+    double sum_time;
+    double sum;
+};
+
+double now_sec() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Roughly the normal(pi, 1) inputs of taylor_parallel, but computable in parallel
+double input_value(size_t i) {
+    unsigned long long h = (unsigned long long)i * 0x9E3779B97F4A7C15ull;
+    h ^= h >> 29;
+    return M_PI + ((double)(h & 0xffff) / 0xffff - 0.5) * 4.0;
+}
+
+bench_result run_kernels(ThreadPool& pool, size_t n, double* x, double* y, float* f) {
+    bench_result r = {};
+    pool.parallel_for(n, GRAIN, [=](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            x[i] = input_value(i);
+            f[i] = (float)(x[i] - M_PI);
+        }
+    });
+
+    r.taylor_time = 1e30;
+    r.sum_time = 1e30;
+    for (int t = 0; t < TRIALS; t++) {
+        double start = now_sec();
+        pool.parallel_for(n, GRAIN, [=](size_t begin, size_t end) {
+            ispc::sinx_ispc((int)(end - begin), TERMS, x + begin, y + begin);
+        });
+        r.taylor_time = min(r.taylor_time, now_sec() - start);
+
+        mutex sum_mutex;
+        double sum = 0;
+        start = now_sec();
+        pool.parallel_for(n, GRAIN, [&, f](size_t begin, size_t end) {
+            float partial = ispc::sum_array((int)(end - begin), f + begin);
+            lock_guard<mutex> lock(sum_mutex);
+            sum += partial;
+        });
+        r.sum_time = min(r.sum_time, now_sec() - start);
+        r.sum = sum;
+    }
+    return r;
+}
+
+void report(const string& name, size_t n, const bench_result& r) {
+    // taylor reads x and writes y, the sum reads one float per element
+    double taylor_gb = 2.0 * n * sizeof(double) / 1e9;
+    double sum_gb = 1.0 * n * sizeof(float) / 1e9;
+    cout << left << setw(26) << name << right << fixed << setprecision(3)
+         << setw(10) << r.alloc_time
+         << setw(12) << r.taylor_time << setw(9) << setprecision(1) << taylor_gb / r.taylor_time
+         << setw(12) << setprecision(4) << r.sum_time << setw(9) << setprecision(1) << sum_gb / r.sum_time
+         << "   (sum " << setprecision(0) << r.sum << ")" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = 100000000;
+    bool pin = false;
+    for (int a = 1; a < argc; a++) {
+        if (string(argv[a]) == "pin")
+            pin = true;
+        else
+            n = strtoull(argv[a], NULL, 10);
+    }
+    ThreadPool pool(0, pin);
+
+    cout << "NUMA nodes: " << numa_node_count() << ", pool threads: " << pool.size()
+         << (pin ? " (pinned)" : " (not pinned)") << ", elements: " << n << endl;
+    cout << left << setw(26) << "allocation" << right
+         << setw(10) << "alloc s" << setw(12) << "taylor s" << setw(9) << "GB/s"
+         << setw(12) << "sum s" << setw(9) << "GB/s" << endl;
+
+    {
+        double start = now_sec();
+        vector<double> x(n), y(n);
+        vector<float> f(n);
+        double alloc_time = now_sec() - start;
+        bench_result r = run_kernels(pool, n, x.data(), y.data(), f.data());
+        r.alloc_time = alloc_time;
+        report("std::vector", n, r);
+    }
+
+    for (HugePages huge : { HugePages::None, HugePages::Transparent, HugePages::Explicit }) {
+        double start = now_sec();
+        NumaBuffer<double> x(n, pool, huge), y(n, pool, huge);
+        NumaBuffer<float> f(n, pool, huge);
+        double alloc_time = now_sec() - start;
+        bench_result r = run_kernels(pool, n, x.data(), y.data(), f.data());
+        r.alloc_time = alloc_time;
+        // explicit huge pages fall back to transparent ones when none are reserved
+        report(string("NumaBuffer, ") + huge_pages_name(x.huge_pages()), n, r);
+    }
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+#ifndef NUMA_BUFFER_H
+#define NUMA_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <new>
+#include <utility>
+#include <type_traits>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include "thread_pool.h"
+
+/*
+    Large array whose pages are placed by the threads that will use them.
+
+    Linux puts a page on the NUMA node of the thread that first writes it. A
+    std::vector zeroes its elements on the constructing thread, so all 800 MB
+    of a 100M-double vector land on the main thread's socket and every worker
+    on the other socket reads its data across the interconnect.
+
+    NumaBuffer maps the memory untouched and zeroes it with
+    pool.parallel_for_static(), so each page is first touched by the worker
+    whose static_range() slice contains it. ThreadPool::parallel_for() starts
+    every worker on that same slice, so later loops over the buffer read local
+    memory except for stolen chunks. Build the pool with pin = true, otherwise
+    the scheduler may move a worker to the other node after the first touch.
+
+    The storage is aligned to at least BUFFER_ALIGNMENT bytes (a cache line,
+    enough for AVX-512 loads in the ISPC kernels).
+
+    Huge pages (cut TLB misses when streaming over hundreds of MB):
+        HugePages::None          normal 4 KB pages
+        HugePages::Transparent   madvise(MADV_HUGEPAGE) on a 2 MB aligned range
+        HugePages::Explicit      MAP_HUGETLB from the reserved pool (vm.nr_hugepages),
+                                 falls back to Transparent if the pool is empty
+    huge_pages() tells which one was actually obtained.
+*/
+
+enum class HugePages { None, Transparent, Explicit };
+
+const size_t BUFFER_ALIGNMENT = 64;
+const size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+inline const char* huge_pages_name(HugePages h) {
+    switch (h) {
+    case HugePages::Transparent: return "transparent";
+    case HugePages::Explicit: return "explicit";
+    default: return "none";
+    }
+}
+
+// Number of NUMA nodes the kernel reports (1 when unknown)
+inline int numa_node_count() {
+    int nodes = 0;
+#ifdef __linux__
+    char path[64];
+    for (;;) {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d", nodes);
+        if (access(path, F_OK) != 0)
+            break;
+        nodes++;
+    }
+#endif
+    return nodes > 0 ? nodes : 1;
+}
+
+template <typename T>
+class NumaBuffer {
+    static_assert(std::is_trivially_copyable<T>::value, "NumaBuffer holds plain numeric data");
+
+public:
+    NumaBuffer() = default;
+
+    // n zeroed elements, first-touched in parallel by the pool's workers
+    NumaBuffer(size_t n, ThreadPool& pool, HugePages huge = HugePages::None) : size_(n) {
+        allocate(n * sizeof(T), huge);
+        T* data = data_;
+        pool.parallel_for_static(n, [data](size_t begin, size_t end) {
+            std::memset(static_cast<void*>(data + begin), 0, (end - begin) * sizeof(T));
+        });
+    }
+
+    ~NumaBuffer() { release(); }
+
+    NumaBuffer(const NumaBuffer&) = delete;
+    NumaBuffer& operator=(const NumaBuffer&) = delete;
+
+    NumaBuffer(NumaBuffer&& other) noexcept { swap(other); }
+    NumaBuffer& operator=(NumaBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            swap(other);
+        }
+        return *this;
+    }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    size_t size() const { return size_; }
+    T& operator[](size_t i) { return data_[i]; }
+    const T& operator[](size_t i) const { return data_[i]; }
+    T* begin() { return data_; }
+    T* end() { return data_ + size_; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+    HugePages huge_pages() const { return huge_; }
+
+private:
+    void swap(NumaBuffer& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(base_, other.base_);
+        std::swap(mapped_, other.mapped_);
+        std::swap(huge_, other.huge_);
+    }
+
+    static size_t round_up(size_t x, size_t to) { return (x + to - 1) / to * to; }
+
+    void allocate(size_t bytes, HugePages huge) {
+        if (bytes == 0)
+            bytes = 1;
+#ifdef __linux__
+        if (huge == HugePages::Explicit) {
+            mapped_ = round_up(bytes, HUGE_PAGE_SIZE);
+            base_ = mmap(nullptr, mapped_, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (base_ != MAP_FAILED) {
+                huge_ = HugePages::Explicit;
+                data_ = static_cast<T*>(base_);
+                return;
+            }
+            huge = HugePages::Transparent;
+        }
+
+        // huge pages need a 2 MB aligned range, so map one extra huge page to align inside it
+        size_t align = huge == HugePages::Transparent ? HUGE_PAGE_SIZE : (size_t)sysconf(_SC_PAGESIZE);
+        mapped_ = round_up(bytes, align) + (huge == HugePages::Transparent ? HUGE_PAGE_SIZE : 0);
+        base_ = mmap(nullptr, mapped_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base_ == MAP_FAILED) {
+            base_ = nullptr;
+            throw std::bad_alloc();
+        }
+        char* aligned = reinterpret_cast<char*>(round_up(reinterpret_cast<uintptr_t>(base_), align));
+#ifdef MADV_HUGEPAGE
+        if (huge == HugePages::Transparent && madvise(aligned, round_up(bytes, align), MADV_HUGEPAGE) == 0)
+            huge_ = HugePages::Transparent;
+#endif
+        data_ = reinterpret_cast<T*>(aligned);
+#else
+        (void)huge;
+        base_ = std::aligned_alloc(BUFFER_ALIGNMENT, round_up(bytes, BUFFER_ALIGNMENT));
+        if (base_ == nullptr)
+            throw std::bad_alloc();
+        data_ = static_cast<T*>(base_);
+#endif
+    }
+
+    void release() {
+        if (base_ == nullptr)
+            return;
+#ifdef __linux__
+        munmap(base_, mapped_);
+#else
+        std::free(base_);
+#endif
+        base_ = nullptr;
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    T* data_ = nullptr;
+    size_t size_ = 0;
+    void* base_ = nullptr;
+    size_t mapped_ = 0;
+    HugePages huge_ = HugePages::None;
+};
+
+#endif
@@ -0,0 +1,230 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <cstddef>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/*
+    Persistent work-stealing thread pool.
+
+    Threads are created once and sleep between jobs, so calling parallel_for()
+    in a loop costs a wake-up instead of thread creation.
+
+    parallel_for(n, grain, body) first gives every worker the same contiguous
+    slice it would get from a static split (static_range()), so data that was
+    first-touched with the same split stays local. A worker eats its slice from
+    the front, grain elements at a time. When its slice is empty it steals the
+    back half of the largest remaining slice, so a slow core (SMT sibling,
+    efficiency core, noisy neighbour) doesn't leave a tail straggler.
+
+    The calling thread works as worker 0 and only returns when every element
+    has been processed.
+*/
+class ThreadPool {
+public:
+    // num_threads <= 0 uses every hardware thread; pin binds worker i to CPU i
+    explicit ThreadPool(int num_threads = 0, bool pin = false) {
+        if (num_threads <= 0)
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+        slices_ = std::vector<Slice>(num_threads);
+        if (pin)
+            pin_to_cpu(0);
+        for (int w = 1; w < num_threads; w++) {
+            workers_.emplace_back([this, w, pin]() {
+                if (pin)
+                    pin_to_cpu(w);
+                worker_loop(w);
+            });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            shutdown_ = true;
+        }
+        job_ready_.notify_all();
+        for (auto& t : workers_)
+            t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return (int)slices_.size(); }
+
+    // The slice worker w starts with when [0, n) is split over num_workers
+    static void static_range(size_t n, int num_workers, int w, size_t& begin, size_t& end) {
+        size_t chunk_size = n / num_workers;
+        size_t remainder = n % num_workers;
+        begin = w * chunk_size + std::min<size_t>(w, remainder);
+        end = begin + chunk_size + (w < (int)remainder ? 1 : 0);
+    }
+
+    // Function to run body(begin, end) over [0, n) in chunks of about grain elements
+    void parallel_for(size_t n, size_t grain, const std::function<void(size_t, size_t)>& body) {
+        if (grain == 0)
+            grain = 1;
+        run(n, grain, true, body);
+    }
+
+    /*
+        Function to run body(begin, end) once per worker on its (non-empty)
+        static_range() slice, without stealing. Used where the partitioning
+        itself matters, e.g. first-touching memory so that every page lands on
+        the NUMA node of the worker that will later start on it.
+    */
+    void parallel_for_static(size_t n, const std::function<void(size_t, size_t)>& body) {
+        run(n, n, false, body);
+    }
+
+    // Shared pool for code that doesn't manage its own
+    static ThreadPool& global() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+private:
+    struct Slice {
+        std::mutex mutex;
+        size_t begin = 0, end = 0;
+    };
+
+    static void pin_to_cpu(int w) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(w % std::max(1u, std::thread::hardware_concurrency()), &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+        (void)w;
+#endif
+    }
+
+    // Function to hand a job to all workers and take part in it as worker 0
+    void run(size_t n, size_t grain, bool allow_steal, const std::function<void(size_t, size_t)>& body) {
+        if (n == 0)
+            return;
+        for (int w = 0; w < size(); w++) {
+            std::lock_guard<std::mutex> lock(slices_[w].mutex);
+            static_range(n, size(), w, slices_[w].begin, slices_[w].end);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            body_ = &body;
+            grain_ = grain;
+            steal_ = allow_steal;
+            working_ = size() - 1;
+            generation_++;
+        }
+        job_ready_.notify_all();
+
+        run_job(0);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        job_done_.wait(lock, [this]() { return working_ == 0; });
+        body_ = nullptr;
+    }
+
+    // Take the next grain of the worker's own slice
+    bool take_own(int w, size_t& begin, size_t& end) {
+        Slice& s = slices_[w];
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.begin >= s.end)
+            return false;
+        begin = s.begin;
+        end = std::min(s.end, s.begin + grain_);
+        s.begin = end;
+        return true;
+    }
+
+    // Move the back half of the largest other slice into the worker's own slice
+    bool steal(int w) {
+        int victim = -1;
+        size_t most = 0;
+        for (int v = 0; v < size(); v++) {
+            if (v == w)
+                continue;
+            std::lock_guard<std::mutex> lock(slices_[v].mutex);
+            size_t left = slices_[v].end - slices_[v].begin;
+            if (left > most) {
+                most = left;
+                victim = v;
+            }
+        }
+        if (victim < 0)
+            return false;
+
+        size_t begin, end;
+        {
+            std::lock_guard<std::mutex> lock(slices_[victim].mutex);
+            Slice& s = slices_[victim];
+            size_t left = s.end - s.begin;
+            if (left == 0)
+                return true;    // drained meanwhile, look again
+            // a single grain is taken whole, otherwise split it in half
+            size_t take = left <= grain_ ? left : left / 2;
+            begin = s.end - take;
+            end = s.end;
+            s.end = begin;
+        }
+        std::lock_guard<std::mutex> lock(slices_[w].mutex);
+        slices_[w].begin = begin;
+        slices_[w].end = end;
+        return true;
+    }
+
+    void run_job(int w) {
+        const std::function<void(size_t, size_t)>& body = *body_;
+        for (;;) {
+            size_t begin, end;
+            if (take_own(w, begin, end)) {
+                body(begin, end);
+            } else if (!steal_ || !steal(w)) {
+                return;
+            }
+        }
+    }
+
+    void worker_loop(int w) {
+        unsigned seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                job_ready_.wait(lock, [this, seen]() { return generation_ != seen || shutdown_; });
+                if (shutdown_)
+                    return;
+                seen = generation_;
+            }
+            run_job(w);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (--working_ == 0)
+                    job_done_.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::vector<Slice> slices_;
+    std::mutex mutex_;
+    std::condition_variable job_ready_;
+    std::condition_variable job_done_;
+    const std::function<void(size_t, size_t)>* body_ = nullptr;
+    size_t grain_ = 1;
+    bool steal_ = true;
+    unsigned generation_ = 0;
+    int working_ = 0;
+    bool shutdown_ = false;
+};
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef IDX_FILE_H
+#define IDX_FILE_H
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+    Read-only view of an IDX file (the format MNIST is distributed in) through mmap.
+
+    Header: two zero bytes, a type code (0x08 = unsigned byte, the only one
+    MNIST uses), the number of dimensions, then one big-endian 32-bit size per
+    dimension. The data follows, row-major. The file is mapped, not read, so
+    the 47 MB of training images cost no copy and the pages come from the page
+    cache as they are touched. Files must be uncompressed (gunzip the
+    *-ubyte.gz downloads first).
+
+    Errors (missing file, bad magic, truncated data) throw std::runtime_error.
+*/
+class IdxFile {
+public:
+    explicit IdxFile(const std::string& path) : path_(path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("cannot open " + path);
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < 4) {
+            close(fd);
+            throw std::runtime_error(path + " is not an IDX file");
+        }
+        size_ = (size_t)st.st_size;
+        void* map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED)
+            throw std::runtime_error("cannot map " + path);
+        base_ = static_cast<const uint8_t*>(map);
+        madvise(map, size_, MADV_SEQUENTIAL);
+
+        if (base_[0] != 0 || base_[1] != 0 || base_[2] != 0x08)
+            fail("is not an unsigned byte IDX file (gzip compressed?)");
+        int ndims = base_[3];
+        size_t header = 4 + 4 * (size_t)ndims;
+        if (ndims == 0 || size_ < header)
+            fail("has a truncated header");
+        size_t items = 1;
+        for (int d = 0; d < ndims; d++) {
+            const uint8_t* p = base_ + 4 + 4 * d;
+            dims_.push_back((uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3]);
+            items *= dims_.back();
+        }
+        if (size_ < header + items)
+            fail("is shorter than its header says");
+        data_ = base_ + header;
+    }
+
+    ~IdxFile() {
+        if (base_ != nullptr)
+            munmap(const_cast<uint8_t*>(base_), size_);
+    }
+
+    IdxFile(const IdxFile&) = delete;
+    IdxFile& operator=(const IdxFile&) = delete;
+
+    const std::vector<uint32_t>& dims() const { return dims_; }
+    // Number of items (first dimension)
+    size_t count() const { return dims_[0]; }
+    // Bytes per item (product of the other dimensions, 1 for labels)
+    size_t item_size() const {
+        size_t s = 1;
+        for (size_t d = 1; d < dims_.size(); d++)
+            s *= dims_[d];
+        return s;
+    }
+    const uint8_t* data() const { return data_; }
+    const uint8_t* item(size_t i) const { return data_ + i * item_size(); }
+
+private:
+    [[noreturn]] void fail(const std::string& what) {
+        munmap(const_cast<uint8_t*>(base_), size_);
+        base_ = nullptr;
+        throw std::runtime_error(path_ + " " + what);
+    }
+
+    std::string path_;
+    const uint8_t* base_ = nullptr;
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<uint32_t> dims_;
+};
+
+#endif
@@ -2,6 +2,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <unistd.h>
+
+#define NUM_CIRCLES 100000000
+#define DEFAULT_CHUNK (1 << 16)
+// -p runs rank 0 -> 1 -> 2 -> 3 as a streaming pipeline: radius, diameter, circumference, area
+#define NUM_STAGES 4
+#define SWEEP_MIN_CHUNK (1 << 10)
+#define SWEEP_MAX_CHUNK (1 << 22)
 
 struct circle {
     int *radius;
@@ -26,15 +34,249 @@ void free_circle(struct circle *param) {
     free(param->area);
 }
 
+// Per-stage timings of one pipeline run
+struct stage_times {
+    double compute;     // time spent in the stage's loop
+    double wait;        // time blocked on MPI_Wait (upstream data or a free send buffer)
+    double elapsed;     // first receive posted to last send completed
+};
+
+// Function to compute one chunk of a stage, elements [begin, begin + len)
+static void compute_chunk(int stage, int begin, int len, const void *in, void *out, double *area_sum) {
+    if (stage == 0) {
+        int *radius = (int *)out;
+        for (int k = 0; k < len; k++) {
+            radius[k] = (begin + k) % 100;
+        }
+    } else if (stage == 1) {
+        const int *radius = (const int *)in;
+        int *diameter = (int *)out;
+        for (int k = 0; k < len; k++) {
+            diameter[k] = 2 * radius[k];
+        }
+    } else if (stage == 2) {
+        const int *diameter = (const int *)in;
+        double *circumference = (double *)out;
+        for (int k = 0; k < len; k++) {
+            circumference[k] = 3.14159 * diameter[k];
+        }
+    } else {
+        // the sink only keeps the sum of the areas, for the check against a serial run
+        const double *circumference = (const double *)in;
+        double sum = 0;
+        for (int k = 0; k < len; k++) {
+            sum += (circumference[k] / (2 * M_PI)) * (circumference[k] / (2 * M_PI)) * M_PI;
+        }
+        *area_sum += sum;
+    }
+}
+
+/*
+    Streaming pipeline: the arrays move in chunks of `chunk` elements, so stage
+    s works on chunk c while stage s + 1 works on chunk c - 1. Every stage has
+    two input and two output chunk buffers: the receive of chunk c + 1 is posted
+    before chunk c is computed, and the send of chunk c goes out with MPI_Isend
+    while chunk c + 1 is computed. A buffer is only reused after the request
+    that last used it (two chunks earlier) has completed. Memory per rank is
+    4 chunks instead of the full arrays.
+*/
+static void run_pipeline(int stage, int num_circles, int chunk, struct stage_times *times, double *area_sum) {
+    MPI_Datatype in_type = stage == 3 ? MPI_DOUBLE : MPI_INT;
+    MPI_Datatype out_type = stage == 2 ? MPI_DOUBLE : MPI_INT;
+    void *in[2], *out[2];
+    MPI_Request recv_req[2] = { MPI_REQUEST_NULL, MPI_REQUEST_NULL };
+    MPI_Request send_req[2] = { MPI_REQUEST_NULL, MPI_REQUEST_NULL };
+    int num_chunks = (num_circles + chunk - 1) / chunk;
+
+    for (int b = 0; b < 2; b++) {
+        in[b] = malloc((size_t)chunk * sizeof(double));
+        out[b] = malloc((size_t)chunk * sizeof(double));
+        if (in[b] == NULL || out[b] == NULL) {
+            fprintf(stderr, "Chunk allocation failed on stage %d\n", stage);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    times->compute = 0;
+    times->wait = 0;
+    *area_sum = 0;
+
+    double start = MPI_Wtime();
+    if (stage > 0) {
+        int len = num_circles < chunk ? num_circles : chunk;
+        MPI_Irecv(in[0], len, in_type, stage - 1, 0, MPI_COMM_WORLD, &recv_req[0]);
+    }
+    for (int c = 0; c < num_chunks; c++) {
+        int b = c & 1;
+        int begin = c * chunk;
+        int len = num_circles - begin < chunk ? num_circles - begin : chunk;
+        double t0 = MPI_Wtime();
+        if (stage > 0) {
+            // post the next receive first so upstream can keep sending
+            if (c + 1 < num_chunks) {
+                int next_begin = begin + chunk;
+                int next_len = num_circles - next_begin < chunk ? num_circles - next_begin : chunk;
+                MPI_Irecv(in[b ^ 1], next_len, in_type, stage - 1, 0, MPI_COMM_WORLD, &recv_req[b ^ 1]);
+            }
+            MPI_Wait(&recv_req[b], MPI_STATUS_IGNORE);
+        }
+        if (stage < NUM_STAGES - 1) {
+            MPI_Wait(&send_req[b], MPI_STATUS_IGNORE);
+        }
+        double t1 = MPI_Wtime();
+        compute_chunk(stage, begin, len, in[b], out[b], area_sum);
+        double t2 = MPI_Wtime();
+        if (stage < NUM_STAGES - 1) {
+            MPI_Isend(out[b], len, out_type, stage + 1, 0, MPI_COMM_WORLD, &send_req[b]);
+        }
+        times->wait += t1 - t0;
+        times->compute += t2 - t1;
+    }
+    double t0 = MPI_Wtime();
+    MPI_Waitall(2, send_req, MPI_STATUSES_IGNORE);
+    double end = MPI_Wtime();
+    times->wait += end - t0;
+    times->elapsed = end - start;
+
+    for (int b = 0; b < 2; b++) {
+        free(in[b]);
+        free(out[b]);
+    }
+}
+
+// Function to run the pipeline once and gather the stage timings on rank 0; returns the pipeline time on rank 0
+static double pipeline_once(int world_rank, int num_circles, int chunk, struct stage_times *all, int *correct) {
+    struct stage_times mine = { 0, 0, 0 };
+    double area_sum = 0;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (world_rank < NUM_STAGES) {
+        run_pipeline(world_rank, num_circles, chunk, &mine, &area_sum);
+    }
+    MPI_Gather(&mine, 3, MPI_DOUBLE, all, 3, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+    // the sink checks its sum against a serial pass in the same order
+    int ok = 1;
+    if (world_rank == NUM_STAGES - 1) {
+        double expected = 0;
+        for (int c = 0; c < num_circles; c += chunk) {
+            int len = num_circles - c < chunk ? num_circles - c : chunk;
+            double sum = 0;
+            for (int k = 0; k < len; k++) {
+                double circumference = 3.14159 * (2 * ((c + k) % 100));
+                sum += (circumference / (2 * M_PI)) * (circumference / (2 * M_PI)) * M_PI;
+            }
+            expected += sum;
+        }
+        ok = area_sum == expected;
+    }
+    MPI_Reduce(&ok, correct, 1, MPI_INT, MPI_LAND, 0, MPI_COMM_WORLD);
+
+    double slowest = 0;
+    for (int s = 0; s < NUM_STAGES; s++) {
+        if (all != NULL && all[s].elapsed > slowest) {
+            slowest = all[s].elapsed;
+        }
+    }
+    return slowest;
+}
+
+// Function to print the per-stage report of one pipeline run
+static void report_pipeline(int num_circles, int chunk, const struct stage_times *all, double total, int correct) {
+    static const char *names[NUM_STAGES] = { "radius", "diameter", "circumference", "area" };
+    printf("Pipeline: %d circles in chunks of %d (%d chunks), %f seconds, %.1f Mcircles/s, %s\n",
+           num_circles, chunk, (num_circles + chunk - 1) / chunk, total, num_circles / total / 1e6,
+           correct ? "areas verified" : "areas are incorrect");
+    printf("%-6s %-14s %12s %12s %12s %16s\n", "rank", "stage", "compute s", "wait s", "elapsed s", "compute Mcirc/s");
+    for (int s = 0; s < NUM_STAGES; s++) {
+        printf("%-6d %-14s %12f %12f %12f %16.1f\n", s, names[s], all[s].compute, all[s].wait,
+               all[s].elapsed, num_circles / all[s].compute / 1e6);
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-n circles] [-p [-c chunk] | -S]\n", prog);
+    fprintf(stderr, "  default: each stage sends its full array to the next one when done\n");
+    fprintf(stderr, "  -n  number of circles, default %d\n", NUM_CIRCLES);
+    fprintf(stderr, "  -p  streaming pipeline, chunks sent with MPI_Isend/MPI_Irecv double buffering\n");
+    fprintf(stderr, "  -c  pipeline chunk size in elements, default %d\n", DEFAULT_CHUNK);
+    fprintf(stderr, "  -S  pipeline chunk-size sweep from %d to %d\n", SWEEP_MIN_CHUNK, SWEEP_MAX_CHUNK);
+    fprintf(stderr, "  needs at least %d processes\n", NUM_STAGES);
+}
+
 int main(int argc, char **argv) {
     int world_size, world_rank;
     double start_time, end_time;
-    const int num_circles = 1e8;
+    int num_circles = NUM_CIRCLES;
 
     MPI_Init(&argc, &argv);
     MPI_Comm_size(MPI_COMM_WORLD, &world_size);
     MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
 
+    // Parse command line options (every rank parses the same argv)
+    int pipeline = 0, sweep = 0, chunk = DEFAULT_CHUNK;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:pc:S")) != -1) {
+        switch (opt) {
+        case 'n':
+            num_circles = (int)strtod(optarg, NULL);
+            break;
+        case 'p':
+            pipeline = 1;
+            break;
+        case 'c':
+            chunk = atoi(optarg);
+            break;
+        case 'S':
+            sweep = 1;
+            break;
+        default:
+            if (world_rank == 0) usage(argv[0]);
+            MPI_Finalize();
+            return 1;
+        }
+    }
+    if (num_circles < 1 || chunk < 1 || world_size < NUM_STAGES) {
+        if (world_rank == 0) usage(argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+
+    if (pipeline || sweep) {
+        // rank 0 gathers every rank's timings, ranks past the last stage report zeros
+        struct stage_times *gathered = NULL;
+        if (world_rank == 0) {
+            gathered = (struct stage_times *)malloc(world_size * sizeof(struct stage_times));
+        }
+        int correct = 0;
+        if (pipeline) {
+            double total = pipeline_once(world_rank, num_circles, chunk, gathered, &correct);
+            if (world_rank == 0) report_pipeline(num_circles, chunk, gathered, total, correct);
+        }
+        if (sweep) {
+            if (world_rank == 0) {
+                printf("Chunk-size sweep, %d circles\n", num_circles);
+                printf("%10s %12s %12s %18s %12s\n", "chunk", "time s", "Mcircles/s", "busiest stage s", "max wait s");
+            }
+            for (int c = SWEEP_MIN_CHUNK; c <= SWEEP_MAX_CHUNK; c *= 4) {
+                int size = c < num_circles ? c : num_circles;
+                double total = pipeline_once(world_rank, num_circles, size, gathered, &correct);
+                if (world_rank == 0) {
+                    double busiest = 0, max_wait = 0;
+                    for (int s = 0; s < NUM_STAGES; s++) {
+                        if (gathered[s].compute > busiest) busiest = gathered[s].compute;
+                        if (gathered[s].wait > max_wait) max_wait = gathered[s].wait;
+                    }
+                    printf("%10d %12f %12.1f %18f %12f%s\n", size, total, num_circles / total / 1e6, busiest,
+                           max_wait, correct ? "" : "  areas are incorrect");
+                }
+                if (size == num_circles) break;
+            }
+        }
+        free(gathered);
+        MPI_Finalize();
+        return 0;
+    }
+
     // Circle param
     struct circle circles;
     init_circle(&circles, num_circles);
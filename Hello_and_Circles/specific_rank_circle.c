@@ -2,6 +2,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#define NUM_CIRCLES 100000000
 
 struct circle {
     int *radius;
@@ -26,15 +30,160 @@ void free_circle(struct circle *param) {
     free(param->area);
 }
 
+// Function to get this process's peak resident set size in bytes
+static double peak_rss_bytes(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss * 1024.0;    // kilobytes on Linux
+}
+
+/*
+    One summary line per run, so runs at different -np and modes line up:
+        for np in 2 4 8 16 32 64; do
+            mpirun -np $np ./specific_rank_circle; mpirun -np $np ./specific_rank_circle -d
+        done
+    Memory is what each rank mallocs (max over ranks and the sum) and the peak
+    resident set (pages actually touched, max over ranks). Times are the
+    slowest rank's. The area sum is checked against a serial pass when check
+    is set.
+*/
+static void print_summary(const char *mode, int world_rank, int world_size, int num_circles, double allocated,
+                          double distribute, double compute, double area_sum, int check) {
+    double local[4] = { allocated, peak_rss_bytes(), distribute, compute };
+    double max[4];
+    double total_allocated = 0, total_area = 0;
+    MPI_Reduce(local, max, 4, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&allocated, &total_allocated, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&area_sum, &total_area, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    if (world_rank == 0) {
+        double expected = 0;
+        for (int i = 0; i < num_circles; i++) {
+            expected += 3.14 * (i % 100) * (i % 100);
+        }
+        int ok = fabs(total_area - expected) <= 1e-9 * expected;
+        const char *result = !check ? "no area" : ok ? "ok" : "WRONG";
+        printf("%-6s %4s %11s %16s %16s %14s %14s %14s %10s\n", "mode", "np", "circles", "alloc MB/rank",
+               "alloc MB total", "peak RSS MB", "distribute s", "compute s", "check");
+        printf("%-6s %4d %11d %16.1f %16.1f %14.1f %14f %14f %10s\n", mode, world_size, num_circles, max[0] / 1e6,
+               total_allocated / 1e6, max[1] / 1e6, max[2], max[3], result);
+    }
+}
+
+/*
+    Data-parallel decomposition: rank 0 generates the radii and scatters them
+    (the first num_circles % world_size ranks get one more), every rank
+    computes diameter, circumference and area of its slice in one fused pass.
+    Only rank 0 holds a full array (the radii); everyone else allocates 24
+    bytes per circle of its slice, so memory per rank shrinks with -np and no
+    rank sits idle.
+*/
+static void run_data_parallel(int world_rank, int world_size, int num_circles) {
+    int *counts = (int *)malloc(world_size * sizeof(int));
+    int *displs = (int *)malloc(world_size * sizeof(int));
+    for (int r = 0, offset = 0; r < world_size; r++) {
+        counts[r] = num_circles / world_size + (r < num_circles % world_size ? 1 : 0);
+        displs[r] = offset;
+        offset += counts[r];
+    }
+    int count = counts[world_rank];
+    double allocated = 0;
+
+    int *all_radius = NULL;
+    if (world_rank == 0) {
+        all_radius = (int *)malloc(num_circles * sizeof(int));
+        if (all_radius == NULL) {
+            fprintf(stderr, "Memory allocation failed for process %d\n", world_rank);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        allocated += (double)num_circles * sizeof(int);
+        for (int i = 0; i < num_circles; i++) {
+            all_radius[i] = i % 100;
+        }
+    }
+
+    // Only this rank's slice of each quantity
+    struct circle slice;
+    init_circle(&slice, count > 0 ? count : 1);
+    if (slice.radius == NULL || slice.diameter == NULL || slice.circumference == NULL || slice.area == NULL) {
+        fprintf(stderr, "Memory allocation failed for process %d\n", world_rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    allocated += (double)count * (2 * sizeof(int) + 2 * sizeof(double));
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start_time = MPI_Wtime();
+    MPI_Scatterv(all_radius, counts, displs, MPI_INT, slice.radius, count, MPI_INT, 0, MPI_COMM_WORLD);
+    double scatter_time = MPI_Wtime();
+
+    // Fused pass: each radius is loaded once for all three quantities
+    for (int i = 0; i < count; i++) {
+        int r = slice.radius[i];
+        slice.diameter[i] = 2 * r;
+        slice.circumference[i] = 2 * 3.14 * r;
+        slice.area[i] = 3.14 * r * r;
+    }
+    double end_time = MPI_Wtime();
+    printf("Time taken by process %d is %f seconds\n", world_rank, end_time - scatter_time);
+
+    double area_sum = 0;
+    for (int i = 0; i < count; i++) {
+        area_sum += slice.area[i];
+    }
+    fflush(stdout);
+    print_summary("data", world_rank, world_size, num_circles, allocated, scatter_time - start_time,
+                  end_time - scatter_time, area_sum, 1);
+
+    free_circle(&slice);
+    free(all_radius);
+    free(counts);
+    free(displs);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-d] [-n circles]\n", prog);
+    fprintf(stderr, "  default: task parallel, radius broadcast, ranks 0-2 compute one quantity each\n");
+    fprintf(stderr, "  -d  data parallel, radius scattered, every rank computes all quantities of its slice\n");
+    fprintf(stderr, "  -n  number of circles, default %d\n", NUM_CIRCLES);
+}
+
 int main(int argc, char **argv) {
     int world_size, world_rank;
     double start_time, end_time;
-    const int num_circles = 1e8;
+    int num_circles = NUM_CIRCLES;
 
     MPI_Init(&argc, &argv);
     MPI_Comm_size(MPI_COMM_WORLD, &world_size);
     MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
 
+    // Parse command line options (every rank parses the same argv)
+    int data_parallel = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "dn:")) != -1) {
+        switch (opt) {
+        case 'd':
+            data_parallel = 1;
+            break;
+        case 'n':
+            num_circles = (int)strtod(optarg, NULL);
+            break;
+        default:
+            if (world_rank == 0) usage(argv[0]);
+            MPI_Finalize();
+            return 1;
+        }
+    }
+    if (num_circles < 1) {
+        if (world_rank == 0) usage(argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+    if (data_parallel) {
+        run_data_parallel(world_rank, world_size, num_circles);
+        MPI_Finalize();
+        return 0;
+    }
+
     // Initialize circle param
     struct circle circles;
     init_circle(&circles, num_circles);
@@ -47,7 +196,10 @@ int main(int argc, char **argv) {
     }
 
     // Broadcast radius values to all ranks
+    MPI_Barrier(MPI_COMM_WORLD);
+    double bcast_start = MPI_Wtime();
     MPI_Bcast(circles.radius, num_circles, MPI_INT, 0, MPI_COMM_WORLD);
+    double bcast_time = MPI_Wtime() - bcast_start;
 
     // Start timing
     start_time = MPI_Wtime();
@@ -75,6 +227,18 @@ int main(int argc, char **argv) {
     end_time = MPI_Wtime();
     printf("Time taken by process %d is %f seconds\n", world_rank, end_time - start_time);
 
+    // Every rank allocated all four arrays; rank 2 holds all the areas (none below 3 ranks)
+    double area_sum = 0;
+    if (world_rank == 2) {
+        for (int i = 0; i < num_circles; i++) {
+            area_sum += circles.area[i];
+        }
+    }
+    fflush(stdout);
+    print_summary("task", world_rank, world_size, num_circles,
+                  (double)num_circles * (2 * sizeof(int) + 2 * sizeof(double)), bcast_time,
+                  end_time - start_time, area_sum, world_size > 2);
+
     // Free circle param
     free_circle(&circles);
 
@@ -1,10 +1,138 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
 #include <mpi.h>
 #include <time.h>
+#include "splitmix64.h"
+
+#ifdef USE_ISPC
+// sum_array_int() from Code_Experiments/Array_Sum/array_sum.ispc, the same
+// kernel parallel_reduce.h dispatches Sum<int> to
+#include "array_sum_ispc.h"
+#endif
 
 #define ARRAY_SIZE 1000000000   
 #define MASTER 0         
+// -d mode generates and reduces this many elements at a time, so memory does not grow with the array
+#define GEN_BLOCK (1 << 20)
+#define DEFAULT_SEED 2024
+
+/*
+    Counter-based generator for the -d mode: element i is a pure function of
+    (seed, i) (mix64() from splitmix64.h), so every rank generates its own
+    slice without communication and the global array is the same for any
+    number of processes.
+*/
+// Function to generate element i (values between 0-2, like the rand() % 3 data)
+static inline int element(uint64_t seed, long long i) {
+    return (int)(mix64((uint64_t)i + seed * 0xD1B54A32D192ED03ULL) % 3);
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-d] [-n elements] [-s seed]\n", prog);
+    fprintf(stderr, "  default: master allocates %d ints, fills them with rand() and scatters them\n", ARRAY_SIZE);
+    fprintf(stderr, "  -d       every process generates its own slice (counter-based RNG), 64-bit sums\n");
+    fprintf(stderr, "  -n       number of elements for -d (e.g. 1e10), default %d\n", ARRAY_SIZE);
+    fprintf(stderr, "  -s       seed for -d, default %d\n", DEFAULT_SEED);
+}
+
+/*
+    Distributed generation: no process ever holds more than GEN_BLOCK elements.
+    Slices are contiguous, the first n % nprocs processes get one extra element.
+    Map:     generate a block, reduce it (ISPC kernel if available), accumulate in 64 bits.
+    Reduce:  MPI_Reduce of the 64-bit local sums.
+    Verify:  every process recomputes its slice sum straight from the generator,
+             plus a position-weighted checksum that changes if any element is
+             missing, duplicated or misplaced. The checksum does not depend on
+             the number of processes, so runs with different -np can be compared.
+*/
+static void runDistributed(int pid, int nprocs, long long n, uint64_t seed) {
+    long long per_rank = n / nprocs;
+    long long remainder = n % nprocs;
+    long long my_start = pid * per_rank + (pid < remainder ? pid : remainder);
+    long long my_count = per_rank + (pid < remainder ? 1 : 0);
+
+    int* block = (int*)malloc(GEN_BLOCK * sizeof(int));
+    if (block == NULL) {
+        fprintf(stderr, "Memory allocation failed for process %d\n", pid);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    if (pid == MASTER) {
+        printf("Starting MapReduce simulation with %d processes (distributed generation)\n", nprocs);
+        printf("Array size: %lld, slice size: %lld-%lld, seed: %llu\n", n, per_rank,
+               per_rank + (remainder ? 1 : 0), (unsigned long long)seed);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start_time = MPI_Wtime();
+    double gen_time = 0, map_time = 0;
+
+    // Map: generate and reduce one block at a time
+    long long localSum = 0;
+    for (long long b = 0; b < my_count; b += GEN_BLOCK) {
+        int len = (int)(my_count - b < GEN_BLOCK ? my_count - b : GEN_BLOCK);
+        double t0 = MPI_Wtime();
+        for (int k = 0; k < len; k++)
+            block[k] = element(seed, my_start + b + k);
+        double t1 = MPI_Wtime();
+#ifdef USE_ISPC
+        localSum += sum_array_int(len, block);
+#else
+        for (int k = 0; k < len; k++)
+            localSum += block[k];
+#endif
+        gen_time += t1 - t0;
+        map_time += MPI_Wtime() - t1;
+    }
+    double map_end = MPI_Wtime();
+
+    long long globalSum = 0;
+    MPI_Reduce(&localSum, &globalSum, 1, MPI_LONG_LONG, MPI_SUM, MASTER, MPI_COMM_WORLD);
+    double end_time = MPI_Wtime();
+
+    // Verify: the slices must tile [0, n) ...
+    long long counted = 0, expected_start = 0;
+    MPI_Allreduce(&my_count, &counted, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Exscan(&my_count, &expected_start, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    if (pid == 0)
+        expected_start = 0;
+    int ok = counted == n && expected_start == my_start;
+
+    // ... and the reduced sum must match an independent pass over the generator
+    long long checkSum = 0;
+    uint64_t checksum = 0;
+    for (long long i = my_start; i < my_start + my_count; i++) {
+        int v = element(seed, i);
+        checkSum += v;
+        checksum += (uint64_t)(v + 1) * mix64((uint64_t)i);
+    }
+    long long globalCheckSum = 0;
+    uint64_t globalChecksum = 0;
+    int allOk = 0;
+    MPI_Reduce(&checkSum, &globalCheckSum, 1, MPI_LONG_LONG, MPI_SUM, MASTER, MPI_COMM_WORLD);
+    MPI_Reduce(&checksum, &globalChecksum, 1, MPI_UINT64_T, MPI_SUM, MASTER, MPI_COMM_WORLD);
+    MPI_Reduce(&ok, &allOk, 1, MPI_INT, MPI_LAND, MASTER, MPI_COMM_WORLD);
+
+    double times[2] = { gen_time, map_time }, max_times[2];
+    MPI_Reduce(times, max_times, 2, MPI_DOUBLE, MPI_MAX, MASTER, MPI_COMM_WORLD);
+
+    if (pid == MASTER) {
+        double total = end_time - start_time;
+        printf("Generate: %.3f s, Map: %.3f s, Reduce: %.6f s (slowest process)\n",
+               max_times[0], max_times[1], end_time - map_end);
+        printf("Total: %.3f s (%.2f Gelements/s)\n", total, n / total / 1e9);
+        printf("Global sum computed by master process: %lld\n", globalSum);
+        printf("Checksum: %016llx (independent of the number of processes)\n",
+               (unsigned long long)globalChecksum);
+        if (allOk && globalSum == globalCheckSum) {
+            printf("Simulation Accomplished Successfully\n");
+        } else {
+            printf("Global sum is incorrect\n");
+        }
+    }
+    free(block);
+}
 
 int main(int argc,char *argv[]){
     int nprocs;
@@ -20,6 +148,39 @@ int main(int argc,char *argv[]){
     MPI_Comm_rank(MPI_COMM_WORLD, &pid);
     MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
 
+    // Parse command line options (every rank parses the same argv)
+    int distributed = 0;
+    long long n = ARRAY_SIZE;
+    uint64_t seed = DEFAULT_SEED;
+    int opt;
+    while ((opt = getopt(argc, argv, "dn:s:")) != -1) {
+        switch (opt) {
+        case 'd':
+            distributed = 1;
+            break;
+        case 'n':
+            n = (long long)strtod(optarg, NULL);
+            break;
+        case 's':
+            seed = strtoull(optarg, NULL, 10);
+            break;
+        default:
+            if (pid == MASTER) usage(argv[0]);
+            MPI_Finalize();
+            return 1;
+        }
+    }
+    if (distributed) {
+        if (n < 1) {
+            if (pid == MASTER) usage(argv[0]);
+            MPI_Finalize();
+            return 1;
+        }
+        runDistributed(pid, nprocs, n, seed);
+        MPI_Finalize();
+        return 0;
+    }
+
     chunksize = ARRAY_SIZE / nprocs;
 
     chunk = (int *) malloc(chunksize * sizeof(int));
@@ -52,9 +213,14 @@ int main(int argc,char *argv[]){
 
     MPI_Scatter(data, chunksize, MPI_INT, chunk, chunksize, MPI_INT, MASTER, MPI_COMM_WORLD);
 
+    // Map: every process reduces its own chunk
+#ifdef USE_ISPC
+    localSum = (int)sum_array_int(chunksize, chunk);
+#else
     for (i = 0; i < chunksize; i++) {
         localSum += chunk[i];
     }
+#endif
 
     MPI_Reduce(&localSum, &globalSum, 1, MPI_INT, MPI_SUM, MASTER, MPI_COMM_WORLD);
 
@@ -0,0 +1,157 @@
+// gemm_kernels.h
+// Local GEMM of matmul.c: C += A * B on row-major blocks, packed and register-blocked
+#ifndef GEMM_KERNELS_H
+#define GEMM_KERNELS_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef USE_ISPC
+#include "gemm_ispc.h"
+#endif
+
+/*
+    gemmBlocked() follows the Goto/BLIS loop order:
+        for every GEMM_NC columns of B
+            for every GEMM_KC rows of B: pack the KC x NC panel of B
+                for every GEMM_MC rows of A: pack the MC x KC block of A
+                    for every MR x NR tile of C: micro-kernel over KC
+    The packed B panel (KC x NC) stays in L3, the packed A block (MC x KC) in L2
+    and one NR-wide sliver of B (KC x NR) in L1. Packing lays both operands out
+    in the order the micro-kernel reads them, NR (or MR) values per k, so its
+    loads are unit-stride whatever the leading dimensions of the blocks are.
+    Edge slivers are padded with zeros and only the valid part of the tile is
+    added to C.
+
+    The micro-kernel keeps the MR x NR tile of C in registers (12 AVX2
+    registers for 6 x 8 doubles) and does one rank-1 update per k. The C loop
+    has compile-time bounds so the compiler unrolls and vectorizes it; with
+    USE_ISPC full tiles go to gemm_micro_6x8 in gemm.ispc.
+
+    gemmNaive() is the textbook triple loop, kept as the baseline.
+
+    Neither function is threaded: matmul.c gives each thread its own column
+    range of C and its own workspace.
+*/
+
+#define GEMM_MR 6
+#define GEMM_NR 8
+#define GEMM_KC 256
+#define GEMM_MC 96
+#define GEMM_NC 2048
+
+typedef struct {
+    double* a;                  // packed GEMM_MC x GEMM_KC block of A
+    double* b;                  // packed GEMM_KC x GEMM_NC panel of B
+    void (*progress)(void*);    // called between A blocks when not NULL (MPI polling)
+    void* progress_arg;
+} gemm_workspace;
+
+// Function to allocate the packing buffers; returns 0 on failure
+static int gemmWorkspaceInit(gemm_workspace* ws) {
+    memset(ws, 0, sizeof(*ws));
+    ws->a = (double*)aligned_alloc(64, sizeof(double) * GEMM_MC * GEMM_KC);
+    ws->b = (double*)aligned_alloc(64, sizeof(double) * GEMM_KC * GEMM_NC);
+    return ws->a != NULL && ws->b != NULL;
+}
+
+static void gemmWorkspaceFree(gemm_workspace* ws) {
+    free(ws->a);
+    free(ws->b);
+    ws->a = ws->b = NULL;
+}
+
+// Function to pack mc x kc of A into MR-row slivers: out[s][p][r] = A[s * MR + r][p]
+static void gemmPackA(int mc, int kc, const double* A, int lda, double* out) {
+    for (int i = 0; i < mc; i += GEMM_MR) {
+        int rows = mc - i < GEMM_MR ? mc - i : GEMM_MR;
+        for (int p = 0; p < kc; p++) {
+            for (int r = 0; r < rows; r++)
+                out[r] = A[(size_t)(i + r) * lda + p];
+            for (int r = rows; r < GEMM_MR; r++)
+                out[r] = 0.0;
+            out += GEMM_MR;
+        }
+    }
+}
+
+// Function to pack kc x nc of B into NR-column slivers: out[s][p][c] = B[p][s * NR + c]
+static void gemmPackB(int kc, int nc, const double* B, int ldb, double* out) {
+    for (int j = 0; j < nc; j += GEMM_NR) {
+        int cols = nc - j < GEMM_NR ? nc - j : GEMM_NR;
+        for (int p = 0; p < kc; p++) {
+            const double* row = B + (size_t)p * ldb + j;
+            for (int c = 0; c < cols; c++)
+                out[c] = row[c];
+            for (int c = cols; c < GEMM_NR; c++)
+                out[c] = 0.0;
+            out += GEMM_NR;
+        }
+    }
+}
+
+// Function to add the product of an A sliver and a B sliver to the mr x nr corner of a C tile
+static inline void gemmMicro(int kc, const double* a, const double* b, double* C, int ldc, int mr, int nr) {
+#ifdef USE_ISPC
+    if (mr == GEMM_MR && nr == GEMM_NR) {
+        gemm_micro_6x8(kc, (double*)a, (double*)b, C, ldc);
+        return;
+    }
+#endif
+    double acc[GEMM_MR][GEMM_NR];
+    for (int r = 0; r < GEMM_MR; r++)
+        for (int c = 0; c < GEMM_NR; c++)
+            acc[r][c] = 0.0;
+    for (int p = 0; p < kc; p++) {
+        for (int r = 0; r < GEMM_MR; r++)
+            for (int c = 0; c < GEMM_NR; c++)
+                acc[r][c] += a[r] * b[c];
+        a += GEMM_MR;
+        b += GEMM_NR;
+    }
+    for (int r = 0; r < mr; r++)
+        for (int c = 0; c < nr; c++)
+            C[(size_t)r * ldc + c] += acc[r][c];
+}
+
+// Function to compute C += A * B with A m x k, B k x n, C m x n (row-major, leading dimensions given)
+static void gemmBlocked(int m, int n, int k, const double* A, int lda, const double* B, int ldb,
+                        double* C, int ldc, gemm_workspace* ws) {
+    for (int jc = 0; jc < n; jc += GEMM_NC) {
+        int nc = n - jc < GEMM_NC ? n - jc : GEMM_NC;
+        for (int pc = 0; pc < k; pc += GEMM_KC) {
+            int kc = k - pc < GEMM_KC ? k - pc : GEMM_KC;
+            gemmPackB(kc, nc, B + (size_t)pc * ldb + jc, ldb, ws->b);
+            for (int ic = 0; ic < m; ic += GEMM_MC) {
+                int mc = m - ic < GEMM_MC ? m - ic : GEMM_MC;
+                gemmPackA(mc, kc, A + (size_t)ic * lda + pc, lda, ws->a);
+                if (ws->progress != NULL)
+                    ws->progress(ws->progress_arg);
+                for (int jr = 0; jr < nc; jr += GEMM_NR) {
+                    int nr = nc - jr < GEMM_NR ? nc - jr : GEMM_NR;
+                    const double* b = ws->b + (size_t)jr * kc;
+                    for (int ir = 0; ir < mc; ir += GEMM_MR) {
+                        int mr = mc - ir < GEMM_MR ? mc - ir : GEMM_MR;
+                        gemmMicro(kc, ws->a + (size_t)ir * kc, b,
+                                  C + (size_t)(ic + ir) * ldc + jc + jr, ldc, mr, nr);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Function to compute C += A * B with the textbook i-j-k loop
+static void gemmNaive(int m, int n, int k, const double* A, int lda, const double* B, int ldb,
+                      double* C, int ldc) {
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+            double sum = 0.0;
+            for (int p = 0; p < k; p++)
+                sum += A[(size_t)i * lda + p] * B[(size_t)p * ldb + j];
+            C[(size_t)i * ldc + j] += sum;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,111 @@
+// heat_kernels.h
+// Row kernels of heat_solver.c: one x-row of the 5-point (2D) or 7-point (3D) stencil
+#ifndef HEAT_KERNELS_H
+#define HEAT_KERNELS_H
+
+#include <math.h>
+
+#ifdef USE_ISPC
+#include "heat_ispc.h"
+#endif
+
+/*
+    All kernels work on a contiguous x-row: c points at the first cell, north and
+    south at the same x in the rows y - 1 and y + 1, up and down in the planes
+    z - 1 and z + 1. c[-1] and c[len] must be readable.
+
+    Jacobi rows write the average of the neighbors to out. Red-black rows update
+    every other cell in place (c[0], c[2], ...), count cells in total; the other
+    color is only read. When change is not NULL the largest |new - old| of the
+    row is folded into *change (residual checks only, always the C loop).
+    The ISPC versions in heat.ispc add in the same order, so results are
+    bit-identical.
+*/
+
+static inline void heatRow2D(int len, double inv, const double* c, const double* north, const double* south,
+                             double* out, double* change) {
+    if (change != NULL) {
+        double m = *change;
+        for (int i = 0; i < len; i++) {
+            out[i] = (c[i - 1] + c[i + 1] + north[i] + south[i]) * inv;
+            m = fmax(m, fabs(out[i] - c[i]));
+        }
+        *change = m;
+        return;
+    }
+#ifdef USE_ISPC
+    heat_row_2d(len, inv, (double*)c, (double*)north, (double*)south, out);
+#else
+    for (int i = 0; i < len; i++) {
+        out[i] = (c[i - 1] + c[i + 1] + north[i] + south[i]) * inv;
+    }
+#endif
+}
+
+static inline void heatRow3D(int len, double inv, const double* c, const double* north, const double* south,
+                             const double* up, const double* down, double* out, double* change) {
+    if (change != NULL) {
+        double m = *change;
+        for (int i = 0; i < len; i++) {
+            out[i] = (c[i - 1] + c[i + 1] + north[i] + south[i] + up[i] + down[i]) * inv;
+            m = fmax(m, fabs(out[i] - c[i]));
+        }
+        *change = m;
+        return;
+    }
+#ifdef USE_ISPC
+    heat_row_3d(len, inv, (double*)c, (double*)north, (double*)south, (double*)up, (double*)down, out);
+#else
+    for (int i = 0; i < len; i++) {
+        out[i] = (c[i - 1] + c[i + 1] + north[i] + south[i] + up[i] + down[i]) * inv;
+    }
+#endif
+}
+
+static inline void heatRowRB2D(int count, double inv, double* c, const double* north, const double* south,
+                               double* change) {
+    if (change != NULL) {
+        double m = *change;
+        for (int k = 0; k < count; k++) {
+            int i = 2 * k;
+            double v = (c[i - 1] + c[i + 1] + north[i] + south[i]) * inv;
+            m = fmax(m, fabs(v - c[i]));
+            c[i] = v;
+        }
+        *change = m;
+        return;
+    }
+#ifdef USE_ISPC
+    heat_row_rb_2d(count, inv, c, (double*)north, (double*)south);
+#else
+    for (int k = 0; k < count; k++) {
+        int i = 2 * k;
+        c[i] = (c[i - 1] + c[i + 1] + north[i] + south[i]) * inv;
+    }
+#endif
+}
+
+static inline void heatRowRB3D(int count, double inv, double* c, const double* north, const double* south,
+                               const double* up, const double* down, double* change) {
+    if (change != NULL) {
+        double m = *change;
+        for (int k = 0; k < count; k++) {
+            int i = 2 * k;
+            double v = (c[i - 1] + c[i + 1] + north[i] + south[i] + up[i] + down[i]) * inv;
+            m = fmax(m, fabs(v - c[i]));
+            c[i] = v;
+        }
+        *change = m;
+        return;
+    }
+#ifdef USE_ISPC
+    heat_row_rb_3d(count, inv, c, (double*)north, (double*)south, (double*)up, (double*)down);
+#else
+    for (int k = 0; k < count; k++) {
+        int i = 2 * k;
+        c[i] = (c[i - 1] + c[i + 1] + north[i] + south[i] + up[i] + down[i]) * inv;
+    }
+#endif
+}
+
+#endif
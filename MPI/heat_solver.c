@@ -0,0 +1,806 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <mpi.h>
+
+#include "heat_kernels.h"
+#include "ppm_image.h"
+#include "splitmix64.h"
+
+/*
+    Steady-state heat solver on a 2D or 3D grid (MPI + threads + SIMD).
+
+    The plate (or block) starts at 0 degrees; the boundary face y = -1 is held
+    at T_HOT and every other face at 0. Each sweep replaces a cell by the
+    average of its 4 (2D) or 6 (3D) neighbors:
+        jacobi  out-of-place into a second buffer (explicit heat step at the
+                stability limit)
+        rbgs    red-black Gauss-Seidel, in place, red cells then black cells
+    Both give the same field for any decomposition, so the order-independent
+    checksum printed at the end can be compared across -np, -t, -H and -b.
+
+    Decomposition: MPI_Dims_create + MPI_Cart_create over all dimensions,
+    block sizes differ by at most one cell. Inside a rank, pthreads split the
+    outermost dimension (y in 2D, z in 3D); only thread 0 calls MPI.
+
+    Halo exchange: faces are packed into buffers and sent with MPI_Isend/Irecv.
+    The cells that need no halo data are updated while the messages are in
+    flight, the rim after MPI_Waitall.
+
+    Deep halos / communication-avoiding steps (-H depth): halos are `depth`
+    cells deep and exchanged only every `depth` substeps (a substep is a
+    Jacobi sweep or one color of a red-black sweep). Substep k after an
+    exchange also recomputes the cells up to depth - 1 - k deep into the halo,
+    so the next substep still has valid neighbors: fewer, larger messages for
+    a little redundant work. Every substep still sweeps the whole block, so
+    this saves messages, not memory traffic (no cache reuse across substeps
+    as in temporal blocking). Deep halos need the corner cells, so the
+    dimensions are then exchanged one after the other (each including the
+    halos of the previous ones) and only the last one overlaps with
+    computation.
+
+    Cache blocking (-b bx[,by]): cells are visited in x-tiles of bx (and
+    y-tiles of by in 3D), each tile sweeping the whole outer range of the
+    thread, so the rows (2D) or planes (3D) shared by consecutive updates
+    stay in cache.
+
+    Checkpoints (-C k): every k iterations the 2D field, or the middle z-plane
+    in 3D, is written to <prefix>_<iteration>.ppm with writePPMImageMPI() from
+    ppm_image.h. Temperature maps to 256 levels, which colorizeRow() shows as
+    16-level bands, i.e. isotherms.
+
+    Scaling (-S strong|weak): the same solve runs on the first 1, 2, 4, ...
+    ranks (and all of them). Strong scaling keeps the -n grid; weak scaling
+    gives every rank an -n sized block.
+
+    ispc -O2 --opt=disable-fma heat.ispc -o heat_ispc.o -h heat_ispc.h
+    mpicc -O2 -DUSE_ISPC heat_solver.c heat_ispc.o -o heat_solver -lpthread -lm
+    mpirun -np 4 ./heat_solver [-d 2|3] [-n nx[,ny[,nz]]] [-m jacobi|rbgs] [-i iterations] [-t threads]
+                               [-H depth] [-b bx[,by]] [-c every] [-e tolerance] [-C every] [-o prefix]
+                               [-S strong|weak]
+*/
+
+#define T_HOT 100.0
+#define LEVELS 256
+#define DEFAULT_2D 2048
+#define DEFAULT_3D 128
+#define DEFAULT_ITERATIONS 1000
+#define DEFAULT_CHECK 100
+#define DEFAULT_TOLERANCE 1e-6
+#define MAX_THREADS 256
+
+typedef enum { METHOD_JACOBI, METHOD_RBGS } method_t;
+
+typedef struct {
+    int ndims;              // 2 or 3
+    int global[3];          // interior cells per dimension (global[2] = 1 in 2D)
+    method_t method;
+    int iterations;         // sweeps (a red-black sweep is two substeps)
+    int threads;
+    int halo;               // halo depth = substeps between exchanges
+    int tile[2];            // cache tile in x and y (y used in 3D only), 0 = whole range
+    int check_every;        // residual check interval in iterations, 0 = never
+    double tolerance;
+    int checkpoint_every;   // 0 = never
+    const char* prefix;
+    int quiet;              // no per-check output (scaling runs)
+} heat_config;
+
+typedef struct {
+    int lo[3], hi[3];       // owned coordinates, hi exclusive
+} box;
+
+typedef struct {
+    heat_config cfg;
+    MPI_Comm cart;
+    int rank, size;
+    int dims[3], coords[3];
+    int n[3], start[3];     // owned cells and global offset per dimension
+    int h[3], p[3];         // halo depth and padded size per dimension
+    int neighbor[3][2];     // low and high neighbor per dimension (MPI_PROC_NULL at the boundary)
+    double* u;
+    double* next;           // Jacobi only
+    double* send[3][2];
+    double* recv[3][2];
+    box send_box[3][2], recv_box[3][2];
+    size_t face_cells[3];
+    MPI_Request requests[12];
+    int num_requests;
+
+    // thread coordination
+    pthread_barrier_t barrier;
+    double change[MAX_THREADS];
+    int stop;
+    int iterations_done;
+    double* result;         // buffer holding the latest field
+    double max_change;      // last global residual
+    int checks_done;        // residual checks run so far (max_change is only set after one)
+    double exchange_time;   // thread 0 time in packing, MPI calls and unpacking
+
+    // checkpoint plane: ranks in the same y-block of the written plane
+    MPI_Comm plane_comm;
+} heat_solver;
+
+typedef struct {
+    heat_solver* hs;
+    int tid;
+} heat_thread;
+
+// Function to get the first cell and count of block `coord` out of `dims` over n cells
+static void blockRange(int n, int dims, int coord, int* start, int* count) {
+    int base = n / dims, extra = n % dims;
+    *start = coord * base + (coord < extra ? coord : extra);
+    *count = base + (coord < extra ? 1 : 0);
+}
+
+// Index of owned coordinate (x, y, z) in the padded array
+static inline size_t cellIndex(const heat_solver* hs, int x, int y, int z) {
+    return ((size_t)(z + hs->h[2]) * hs->p[1] + (size_t)(y + hs->h[1])) * hs->p[0] + (size_t)(x + hs->h[0]);
+}
+
+static inline int boxEmpty(const box* b) {
+    return b->lo[0] >= b->hi[0] || b->lo[1] >= b->hi[1] || b->lo[2] >= b->hi[2];
+}
+
+// Function to copy a box of the field to (pack = 1) or from (pack = 0) a contiguous buffer
+static void copyBox(heat_solver* hs, double* field, const box* b, double* buffer, int pack) {
+    int len = b->hi[0] - b->lo[0];
+    for (int z = b->lo[2]; z < b->hi[2]; z++) {
+        for (int y = b->lo[1]; y < b->hi[1]; y++) {
+            double* row = field + cellIndex(hs, b->lo[0], y, z);
+            if (pack)
+                memcpy(buffer, row, len * sizeof(double));
+            else
+                memcpy(row, buffer, len * sizeof(double));
+            buffer += len;
+        }
+    }
+}
+
+/*
+    Function to set up the face boxes. The face of dimension d spans the owned
+    range of the other dimensions, plus their halos for the dimensions exchanged
+    before it when the halo is deeper than one cell (corners).
+*/
+static void setupFaces(heat_solver* hs) {
+    int ordered = hs->cfg.halo > 1;
+    for (int d = 0; d < hs->cfg.ndims; d++) {
+        for (int side = 0; side < 2; side++) {
+            box s, r;
+            for (int e = 0; e < 3; e++) {
+                int lo = 0, hi = hs->n[e];
+                if (ordered && e < d) {
+                    lo = -hs->h[e];
+                    hi = hs->n[e] + hs->h[e];
+                }
+                s.lo[e] = r.lo[e] = lo;
+                s.hi[e] = r.hi[e] = hi;
+            }
+            if (side == 0) {
+                s.lo[d] = 0;
+                s.hi[d] = hs->h[d];
+                r.lo[d] = -hs->h[d];
+                r.hi[d] = 0;
+            } else {
+                s.lo[d] = hs->n[d] - hs->h[d];
+                s.hi[d] = hs->n[d];
+                r.lo[d] = hs->n[d];
+                r.hi[d] = hs->n[d] + hs->h[d];
+            }
+            hs->send_box[d][side] = s;
+            hs->recv_box[d][side] = r;
+        }
+        const box* f = &hs->send_box[d][0];
+        hs->face_cells[d] = (size_t)(f->hi[0] - f->lo[0]) * (f->hi[1] - f->lo[1]) * (f->hi[2] - f->lo[2]);
+        for (int side = 0; side < 2; side++) {
+            hs->send[d][side] = (double*)malloc(hs->face_cells[d] * sizeof(double));
+            hs->recv[d][side] = (double*)malloc(hs->face_cells[d] * sizeof(double));
+            if (hs->send[d][side] == NULL || hs->recv[d][side] == NULL) {
+                fprintf(stderr, "Process %d: halo buffer allocation failed\n", hs->rank);
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+        }
+    }
+}
+
+// Function to post both faces of dimension d; a message toward the high side carries tag 2d + 1
+static void postFaces(heat_solver* hs, double* field, int d) {
+    for (int side = 0; side < 2; side++) {
+        MPI_Irecv(hs->recv[d][side], (int)hs->face_cells[d], MPI_DOUBLE, hs->neighbor[d][side], 2 * d + (1 - side),
+                  hs->cart, &hs->requests[hs->num_requests++]);
+    }
+    for (int side = 0; side < 2; side++) {
+        if (hs->neighbor[d][side] != MPI_PROC_NULL)
+            copyBox(hs, field, &hs->send_box[d][side], hs->send[d][side], 1);
+        MPI_Isend(hs->send[d][side], (int)hs->face_cells[d], MPI_DOUBLE, hs->neighbor[d][side], 2 * d + side,
+                  hs->cart, &hs->requests[hs->num_requests++]);
+    }
+}
+
+// Function to wait for the posted faces of dimensions [first, last] and unpack them
+static void finishFaces(heat_solver* hs, double* field, int first, int last) {
+    MPI_Waitall(hs->num_requests, hs->requests, MPI_STATUSES_IGNORE);
+    hs->num_requests = 0;
+    for (int d = first; d <= last; d++) {
+        for (int side = 0; side < 2; side++) {
+            if (hs->neighbor[d][side] != MPI_PROC_NULL)
+                copyBox(hs, field, &hs->recv_box[d][side], hs->recv[d][side], 0);
+        }
+    }
+}
+
+// Function to start the halo exchange; on return only the last posted dimension is in flight
+static void exchangeBegin(heat_solver* hs, double* field) {
+    double start = MPI_Wtime();
+    int last = hs->cfg.ndims - 1;
+    if (hs->cfg.halo > 1) {
+        for (int d = 0; d < last; d++) {
+            postFaces(hs, field, d);
+            finishFaces(hs, field, d, d);
+        }
+        postFaces(hs, field, last);
+    } else {
+        for (int d = 0; d <= last; d++)
+            postFaces(hs, field, d);
+    }
+    hs->exchange_time += MPI_Wtime() - start;
+}
+
+static void exchangeEnd(heat_solver* hs, double* field) {
+    double start = MPI_Wtime();
+    int last = hs->cfg.ndims - 1;
+    finishFaces(hs, field, hs->cfg.halo > 1 ? last : 0, last);
+    hs->exchange_time += MPI_Wtime() - start;
+}
+
+// Function to get the cells updated by a substep extended `extend` cells into the halo, clamped to the grid
+static box updateRegion(const heat_solver* hs, int extend) {
+    box r;
+    for (int d = 0; d < 3; d++) {
+        if (d < hs->cfg.ndims) {
+            r.lo[d] = -extend > -hs->start[d] ? -extend : -hs->start[d];
+            int hi = hs->n[d] + extend, limit = hs->cfg.global[d] - hs->start[d];
+            r.hi[d] = hi < limit ? hi : limit;
+        } else {
+            r.lo[d] = 0;
+            r.hi[d] = 1;
+        }
+    }
+    return r;
+}
+
+/*
+    Function to update the cells of box b owned by thread tid. Threads split the
+    outermost dimension; the inner ones are visited in cache tiles.
+*/
+static void updateBox(heat_solver* hs, const box* b, int tid, double* cur, double* out, int color,
+                      double* change) {
+    if (boxEmpty(b))
+        return;
+    int nd = hs->cfg.ndims, outer = nd - 1;
+    int extent = b->hi[outer] - b->lo[outer];
+    int first = b->lo[outer] + (int)((long long)extent * tid / hs->cfg.threads);
+    int last = b->lo[outer] + (int)((long long)extent * (tid + 1) / hs->cfg.threads);
+    if (first >= last)
+        return;
+
+    int bx = hs->cfg.tile[0] > 0 ? hs->cfg.tile[0] : b->hi[0] - b->lo[0];
+    int by = nd == 3 && hs->cfg.tile[1] > 0 ? hs->cfg.tile[1] : b->hi[1] - b->lo[1];
+    size_t row = hs->p[0], plane = (size_t)hs->p[0] * hs->p[1];
+    double inv = 1.0 / (2 * nd);
+
+    // tile loops over x (and y in 3D); the thread's outer range runs inside each tile
+    int y_lo = nd == 3 ? b->lo[1] : first, y_hi = nd == 3 ? b->hi[1] : last;
+    int z_lo = nd == 3 ? first : 0, z_hi = nd == 3 ? last : 1;
+    if (nd == 2)
+        by = y_hi - y_lo;
+    for (int x0 = b->lo[0]; x0 < b->hi[0]; x0 += bx) {
+        int x1 = x0 + bx < b->hi[0] ? x0 + bx : b->hi[0];
+        for (int y0 = y_lo; y0 < y_hi; y0 += by) {
+            int y1 = y0 + by < y_hi ? y0 + by : y_hi;
+            for (int z = z_lo; z < z_hi; z++) {
+                for (int y = y0; y < y1; y++) {
+                    size_t idx = cellIndex(hs, x0, y, z);
+                    double* c = cur + idx;
+                    if (hs->cfg.method == METHOD_JACOBI) {
+                        if (nd == 2)
+                            heatRow2D(x1 - x0, inv, c, c - row, c + row, out + idx, change);
+                        else
+                            heatRow3D(x1 - x0, inv, c, c - row, c + row, c - plane, c + plane, out + idx, change);
+                    } else {
+                        // first cell of the row with the current color, by global parity
+                        int parity = (hs->start[0] + x0 + hs->start[1] + y + (nd == 3 ? hs->start[2] + z : 0)) & 1;
+                        int skip = (color ^ parity) & 1;
+                        int count = (x1 - x0 - skip + 1) / 2;
+                        c += skip;
+                        if (nd == 2)
+                            heatRowRB2D(count, inv, c, c - row, c + row, change);
+                        else
+                            heatRowRB3D(count, inv, c, c - row, c + row, c - plane, c + plane, change);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Function to write the checkpoint plane (the field in 2D, z = nz / 2 in 3D) as a PPM. Collective on the cart.
+static void writeCheckpoint(heat_solver* hs, const double* field, int iteration) {
+    int* rows_data = NULL;
+    int* rows = NULL;
+    int num_rows = 0;
+
+    if (hs->plane_comm != MPI_COMM_NULL) {
+        int z = hs->cfg.ndims == 3 ? hs->cfg.global[2] / 2 - hs->start[2] : 0;
+        int plane_rank, plane_size;
+        MPI_Comm_rank(hs->plane_comm, &plane_rank);
+        MPI_Comm_size(hs->plane_comm, &plane_size);
+
+        // owned part of the plane as temperature levels
+        int* block = (int*)malloc((size_t)hs->n[0] * hs->n[1] * sizeof(int) + 1);
+        for (int y = 0; y < hs->n[1]; y++) {
+            const double* src = field + cellIndex(hs, 0, y, z);
+            for (int x = 0; x < hs->n[0]; x++) {
+                int level = (int)(src[x] / T_HOT * (LEVELS - 1));
+                block[(size_t)y * hs->n[0] + x] = level < 0 ? 0 : level > LEVELS - 1 ? LEVELS - 1 : level;
+            }
+        }
+
+        // the first rank of the block row assembles full image rows
+        int* counts = NULL;
+        int* displs = NULL;
+        int* gathered = NULL;
+        int width = hs->cfg.global[0];
+        if (plane_rank == 0) {
+            counts = (int*)malloc(plane_size * sizeof(int));
+            displs = (int*)malloc(plane_size * sizeof(int));
+            for (int r = 0, offset = 0; r < plane_size; r++) {
+                int s, c;
+                blockRange(width, hs->dims[0], r, &s, &c);
+                counts[r] = c * hs->n[1];
+                displs[r] = offset;
+                offset += counts[r];
+            }
+            gathered = (int*)malloc((size_t)width * hs->n[1] * sizeof(int));
+            rows_data = (int*)malloc((size_t)width * hs->n[1] * sizeof(int));
+            rows = (int*)malloc(hs->n[1] * sizeof(int));
+        }
+        MPI_Gatherv(block, hs->n[0] * hs->n[1], MPI_INT, gathered, counts, displs, MPI_INT, 0, hs->plane_comm);
+        if (plane_rank == 0) {
+            for (int r = 0; r < plane_size; r++) {
+                int s, c;
+                blockRange(width, hs->dims[0], r, &s, &c);
+                for (int y = 0; y < hs->n[1]; y++)
+                    memcpy(rows_data + (size_t)y * width + s, gathered + displs[r] + (size_t)y * c, c * sizeof(int));
+            }
+            num_rows = hs->n[1];
+            for (int y = 0; y < num_rows; y++)
+                rows[y] = hs->start[1] + y;
+        }
+        free(block);
+        free(counts);
+        free(displs);
+        free(gathered);
+    }
+
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%s_%06d.ppm", hs->cfg.prefix, iteration);
+    int ok = writePPMImageMPI(rows_data, rows, num_rows, hs->cfg.global[0], hs->cfg.global[1], filename, LEVELS,
+                              hs->cart);
+    if (hs->rank == 0)
+        printf("  checkpoint %s%s\n", filename, ok ? "" : " FAILED");
+    free(rows_data);
+    free(rows);
+}
+
+// Per-thread solve loop; thread 0 also does the MPI work between barriers
+static void* solveThread(void* arg) {
+    heat_thread* t = (heat_thread*)arg;
+    heat_solver* hs = t->hs;
+    int tid = t->tid;
+    const heat_config* cfg = &hs->cfg;
+    int substeps = cfg->method == METHOD_RBGS ? 2 : 1;
+    int depth = cfg->halo;
+    long long total = (long long)cfg->iterations * substeps;
+    double change = 0;
+
+    for (long long s = 0; s < total; s++) {
+        int k = (int)(s % depth);
+        int iteration = (int)(s / substeps);
+        int sub = (int)(s % substeps);
+        int measure = cfg->check_every > 0 && (iteration + 1) % cfg->check_every == 0;
+        int checkpoint = cfg->checkpoint_every > 0 && (iteration + 1) % cfg->checkpoint_every == 0;
+        double* cur = cfg->method == METHOD_JACOBI && (s & 1) ? hs->next : hs->u;
+        double* out = cfg->method == METHOD_JACOBI ? (cur == hs->u ? hs->next : hs->u) : cur;
+        double* track = measure ? &change : NULL;
+        if (sub == 0)
+            change = 0;
+
+        if (k == 0) {
+            // overlap: halo-independent cells while the last dimension's faces travel
+            if (tid == 0)
+                exchangeBegin(hs, cur);
+            pthread_barrier_wait(&hs->barrier);
+            box region = updateRegion(hs, depth - 1);
+            box inner = region;
+            for (int d = 0; d < cfg->ndims; d++) {
+                if (inner.lo[d] < 1) inner.lo[d] = 1;
+                if (inner.hi[d] > hs->n[d] - 1) inner.hi[d] = hs->n[d] - 1;
+            }
+            updateBox(hs, &inner, tid, cur, out, sub, track);
+            if (tid == 0)
+                exchangeEnd(hs, cur);
+            pthread_barrier_wait(&hs->barrier);
+
+            // rim: region minus inner, as at most two slabs per dimension
+            if (boxEmpty(&inner)) {
+                updateBox(hs, &region, tid, cur, out, sub, track);
+            } else {
+                box rest = region;
+                for (int d = 0; d < cfg->ndims; d++) {
+                    box slab = rest;
+                    slab.hi[d] = inner.lo[d];
+                    updateBox(hs, &slab, tid, cur, out, sub, track);
+                    slab = rest;
+                    slab.lo[d] = inner.hi[d];
+                    updateBox(hs, &slab, tid, cur, out, sub, track);
+                    rest.lo[d] = inner.lo[d];
+                    rest.hi[d] = inner.hi[d];
+                }
+            }
+        } else {
+            box region = updateRegion(hs, depth - 1 - k);
+            updateBox(hs, &region, tid, cur, out, sub, track);
+        }
+        if (sub == substeps - 1)
+            hs->change[tid] = change;
+        pthread_barrier_wait(&hs->barrier);
+
+        if (sub == substeps - 1 && (measure || checkpoint)) {
+            if (tid == 0) {
+                hs->iterations_done = iteration + 1;
+                hs->result = out;
+                if (measure) {
+                    double local = 0;
+                    for (int i = 0; i < cfg->threads; i++)
+                        local = fmax(local, hs->change[i]);
+                    MPI_Allreduce(&local, &hs->max_change, 1, MPI_DOUBLE, MPI_MAX, hs->cart);
+                    hs->checks_done++;
+                    if (hs->rank == 0 && !cfg->quiet)
+                        printf("  iteration %6d: max change %.3e\n", iteration + 1, hs->max_change);
+                    hs->stop = hs->max_change < cfg->tolerance;
+                }
+                if (checkpoint)
+                    writeCheckpoint(hs, out, iteration + 1);
+            }
+            pthread_barrier_wait(&hs->barrier);
+            if (hs->stop)
+                break;
+        }
+        if (tid == 0) {
+            hs->iterations_done = iteration + 1;
+            hs->result = out;
+        }
+    }
+    return NULL;
+}
+
+// Function to allocate the decomposition, fields and halo buffers; returns 0 if the grid is too small
+static int createSolver(heat_solver* hs, const heat_config* cfg, MPI_Comm comm) {
+    memset(hs, 0, sizeof(*hs));
+    hs->cfg = *cfg;
+    MPI_Comm_size(comm, &hs->size);
+
+    int periods[3] = { 0, 0, 0 };
+    hs->dims[0] = hs->dims[1] = hs->dims[2] = 0;
+    MPI_Dims_create(hs->size, cfg->ndims, hs->dims);
+    if (cfg->ndims == 2)
+        hs->dims[2] = 1;
+    // x is the contiguous dimension: give it the fewest blocks so rows stay long
+    if (hs->dims[0] > hs->dims[cfg->ndims - 1]) {
+        int swap = hs->dims[0];
+        hs->dims[0] = hs->dims[cfg->ndims - 1];
+        hs->dims[cfg->ndims - 1] = swap;
+    }
+    MPI_Cart_create(comm, cfg->ndims, hs->dims, periods, 0, &hs->cart);
+    MPI_Comm_rank(hs->cart, &hs->rank);
+    MPI_Cart_coords(hs->cart, hs->rank, cfg->ndims, hs->coords);
+
+    int ok = 1;
+    for (int d = 0; d < 3; d++) {
+        if (d < cfg->ndims) {
+            blockRange(cfg->global[d], hs->dims[d], hs->coords[d], &hs->start[d], &hs->n[d]);
+            hs->h[d] = cfg->halo;
+            MPI_Cart_shift(hs->cart, d, 1, &hs->neighbor[d][0], &hs->neighbor[d][1]);
+            ok = ok && hs->n[d] >= 2 * cfg->halo;
+        } else {
+            hs->start[d] = 0;
+            hs->n[d] = 1;
+            hs->h[d] = 0;
+            hs->neighbor[d][0] = hs->neighbor[d][1] = MPI_PROC_NULL;
+        }
+        hs->p[d] = hs->n[d] + 2 * hs->h[d];
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_LAND, hs->cart);
+    if (!ok) {
+        MPI_Comm_free(&hs->cart);
+        return 0;
+    }
+
+    size_t cells = (size_t)hs->p[0] * hs->p[1] * hs->p[2];
+    hs->u = (double*)malloc(cells * sizeof(double));
+    hs->next = cfg->method == METHOD_JACOBI ? (double*)malloc(cells * sizeof(double)) : NULL;
+    if (hs->u == NULL || (cfg->method == METHOD_JACOBI && hs->next == NULL)) {
+        fprintf(stderr, "Process %d: field allocation failed\n", hs->rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    // Initial field: 0 inside, T_HOT on the y = -1 boundary (and the halo rows beyond it)
+    for (int z = -hs->h[2]; z < hs->n[2] + hs->h[2]; z++) {
+        for (int y = -hs->h[1]; y < hs->n[1] + hs->h[1]; y++) {
+            double value = hs->start[1] + y < 0 ? T_HOT : 0.0;
+            for (int x = -hs->h[0]; x < hs->n[0] + hs->h[0]; x++) {
+                hs->u[cellIndex(hs, x, y, z)] = value;
+                if (hs->next)
+                    hs->next[cellIndex(hs, x, y, z)] = value;
+            }
+        }
+    }
+    setupFaces(hs);
+
+    // ranks holding the checkpoint plane, grouped by y-block and ordered by x-block
+    int z = cfg->global[2] / 2;
+    int holds = cfg->ndims == 2 || (z >= hs->start[2] && z < hs->start[2] + hs->n[2]);
+    MPI_Comm_split(hs->cart, holds ? hs->coords[1] : MPI_UNDEFINED, hs->coords[0], &hs->plane_comm);
+
+    pthread_barrier_init(&hs->barrier, NULL, cfg->threads);
+    hs->result = hs->u;
+    return 1;
+}
+
+static void destroySolver(heat_solver* hs) {
+    for (int d = 0; d < hs->cfg.ndims; d++) {
+        for (int side = 0; side < 2; side++) {
+            free(hs->send[d][side]);
+            free(hs->recv[d][side]);
+        }
+    }
+    free(hs->u);
+    free(hs->next);
+    pthread_barrier_destroy(&hs->barrier);
+    if (hs->plane_comm != MPI_COMM_NULL)
+        MPI_Comm_free(&hs->plane_comm);
+    MPI_Comm_free(&hs->cart);
+}
+
+// Function to run the solve on all threads; returns the slowest rank's time
+static double runSolver(heat_solver* hs) {
+    pthread_t threads[MAX_THREADS];
+    heat_thread args[MAX_THREADS];
+    MPI_Barrier(hs->cart);
+    double start = MPI_Wtime();
+    for (int t = 0; t < hs->cfg.threads; t++) {
+        args[t].hs = hs;
+        args[t].tid = t;
+        if (t > 0 && pthread_create(&threads[t], NULL, solveThread, &args[t]) != 0) {
+            fprintf(stderr, "Process %d: failed to create thread %d\n", hs->rank, t);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    solveThread(&args[0]);
+    for (int t = 1; t < hs->cfg.threads; t++)
+        pthread_join(threads[t], NULL);
+    double elapsed = MPI_Wtime() - start, slowest;
+    MPI_Allreduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, hs->cart);
+    return slowest;
+}
+
+// Function to hash every owned cell's bits with its global index; the sum does not depend on the decomposition
+static uint64_t fieldChecksum(heat_solver* hs, double* sum) {
+    uint64_t local = 0;
+    double local_sum = 0;
+    for (int z = 0; z < hs->n[2]; z++) {
+        for (int y = 0; y < hs->n[1]; y++) {
+            const double* row = hs->result + cellIndex(hs, 0, y, z);
+            for (int x = 0; x < hs->n[0]; x++) {
+                uint64_t bits;
+                memcpy(&bits, &row[x], sizeof(bits));
+                uint64_t index = ((uint64_t)(hs->start[2] + z) * hs->cfg.global[1] + (hs->start[1] + y)) *
+                                 hs->cfg.global[0] + (hs->start[0] + x);
+                local += mix64(bits ^ mix64(index));
+                local_sum += row[x];
+            }
+        }
+    }
+    uint64_t global = 0;
+    MPI_Allreduce(&local, &global, 1, MPI_UINT64_T, MPI_SUM, hs->cart);
+    MPI_Allreduce(&local_sum, sum, 1, MPI_DOUBLE, MPI_SUM, hs->cart);
+    return global;
+}
+
+static double cellCount(const heat_config* cfg) {
+    return (double)cfg->global[0] * cfg->global[1] * cfg->global[2];
+}
+
+// Function to run one solve and print its report
+static void solveOnce(const heat_config* cfg, int world_rank) {
+    heat_solver hs;
+    if (!createSolver(&hs, cfg, MPI_COMM_WORLD)) {
+        if (world_rank == 0)
+            fprintf(stderr, "Every block needs at least 2 * halo depth cells per dimension\n");
+        return;
+    }
+    if (hs.rank == 0) {
+        printf("Heat %dD %s, grid %d x %d", cfg->ndims, cfg->method == METHOD_JACOBI ? "jacobi" : "rbgs",
+               cfg->global[0], cfg->global[1]);
+        if (cfg->ndims == 3) printf(" x %d", cfg->global[2]);
+        printf(", %d processes (%d x %d", hs.size, hs.dims[0], hs.dims[1]);
+        if (cfg->ndims == 3) printf(" x %d", hs.dims[2]);
+        printf("), %d threads each, halo depth %d, tile %d x %d\n", cfg->threads, cfg->halo, cfg->tile[0],
+               cfg->tile[1]);
+    }
+    double elapsed = runSolver(&hs);
+
+    double exchange = 0, sum = 0;
+    MPI_Reduce(&hs.exchange_time, &exchange, 1, MPI_DOUBLE, MPI_MAX, 0, hs.cart);
+    uint64_t checksum = fieldChecksum(&hs, &sum);
+    if (hs.rank == 0) {
+        double updates = cellCount(cfg) * hs.iterations_done;
+        printf("%d iterations in %.3f s (%.3f ms each), %.1f MLUP/s, halo exchange on thread 0: %.3f s\n",
+               hs.iterations_done, elapsed, elapsed / hs.iterations_done * 1e3, updates / elapsed / 1e6, exchange);
+        if (hs.checks_done > 0)
+            printf("Last max change %.3e (%s)\n", hs.max_change,
+                   hs.max_change < cfg->tolerance ? "converged" : "not converged");
+        else
+            printf("Max change not checked (no residual check in %d iterations)\n", hs.iterations_done);
+        printf("Mean temperature %.6f, checksum %016llx (same for any decomposition)\n", sum / cellCount(cfg),
+               (unsigned long long)checksum);
+    }
+    destroySolver(&hs);
+}
+
+// Function to time the solve on the first 1, 2, 4, ... ranks
+static void scaling(const heat_config* base, int weak, int world_rank, int world_size) {
+    heat_config cfg = *base;
+    cfg.check_every = 0;
+    cfg.checkpoint_every = 0;
+    cfg.quiet = 1;
+    double t1 = 0;
+    if (world_rank == 0) {
+        printf("%s scaling, %s %dD, %d iterations, %d threads per process\n", weak ? "Weak" : "Strong",
+               cfg.method == METHOD_JACOBI ? "jacobi" : "rbgs", cfg.ndims, cfg.iterations, cfg.threads);
+        printf("%6s %12s %20s %12s %12s %12s\n", "procs", "decomp", "grid", "time s", "MLUP/s", "efficiency");
+    }
+    for (int p = 1;; p = p * 2 < world_size ? p * 2 : world_size) {
+        MPI_Comm sub;
+        MPI_Comm_split(MPI_COMM_WORLD, world_rank < p ? 0 : MPI_UNDEFINED, world_rank, &sub);
+        if (sub != MPI_COMM_NULL) {
+            heat_solver hs;
+            heat_config run = cfg;
+            int dims[3] = { 0, 0, 0 };
+            if (weak) {
+                // every rank keeps a base-sized block
+                MPI_Dims_create(p, cfg.ndims, dims);
+                if (dims[0] > dims[cfg.ndims - 1]) {
+                    int swap = dims[0];
+                    dims[0] = dims[cfg.ndims - 1];
+                    dims[cfg.ndims - 1] = swap;
+                }
+                for (int d = 0; d < cfg.ndims; d++)
+                    run.global[d] = base->global[d] * dims[d];
+            }
+            if (createSolver(&hs, &run, sub)) {
+                double elapsed = runSolver(&hs);
+                if (p == 1)
+                    t1 = elapsed;
+                if (hs.rank == 0) {
+                    char decomp[32], grid[48];
+                    snprintf(decomp, sizeof(decomp), cfg.ndims == 3 ? "%dx%dx%d" : "%dx%d", hs.dims[0], hs.dims[1],
+                             hs.dims[2]);
+                    snprintf(grid, sizeof(grid), cfg.ndims == 3 ? "%dx%dx%d" : "%dx%d", run.global[0],
+                             run.global[1], run.global[2]);
+                    double efficiency = weak ? t1 / elapsed : t1 / (p * elapsed);
+                    printf("%6d %12s %20s %12.3f %12.1f %11.1f%%\n", p, decomp, grid, elapsed,
+                           cellCount(&run) * run.iterations / elapsed / 1e6, 100 * efficiency);
+                    fflush(stdout);
+                }
+                destroySolver(&hs);
+            } else if (world_rank == 0) {
+                printf("%6d  grid too small for this decomposition\n", p);
+            }
+            MPI_Comm_free(&sub);
+        }
+        if (p == world_size)
+            break;
+    }
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [options]\n", prog);
+    fprintf(stderr, "  -d 2|3          dimensions, default 2\n");
+    fprintf(stderr, "  -n nx[,ny[,nz]] interior cells, default %d^2 (2D) or %d^3 (3D)\n", DEFAULT_2D, DEFAULT_3D);
+    fprintf(stderr, "  -m jacobi|rbgs  Jacobi or red-black Gauss-Seidel, default jacobi\n");
+    fprintf(stderr, "  -i iterations   sweeps, default %d\n", DEFAULT_ITERATIONS);
+    fprintf(stderr, "  -t threads      threads per process, default 1\n");
+    fprintf(stderr, "  -H depth        deep halos: halo depth = substeps between exchanges, default 1\n");
+    fprintf(stderr, "  -b bx[,by]      cache tile in x (and y in 3D), default none\n");
+    fprintf(stderr, "  -c every        residual check interval, 0 = never, default %d\n", DEFAULT_CHECK);
+    fprintf(stderr, "  -e tolerance    stop when the max change drops below, default %g\n", DEFAULT_TOLERANCE);
+    fprintf(stderr, "  -C every        write a PPM checkpoint every this many iterations\n");
+    fprintf(stderr, "  -o prefix       checkpoint file prefix, default heat\n");
+    fprintf(stderr, "  -S strong|weak  scaling benchmark on 1, 2, 4, ... processes\n");
+}
+
+int main(int argc, char* argv[]) {
+    int provided, world_rank, world_size;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    heat_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.ndims = 2;
+    cfg.method = METHOD_JACOBI;
+    cfg.iterations = DEFAULT_ITERATIONS;
+    cfg.threads = 1;
+    cfg.halo = 1;
+    cfg.check_every = DEFAULT_CHECK;
+    cfg.tolerance = DEFAULT_TOLERANCE;
+    cfg.prefix = "heat";
+    int sizes[3] = { 0, 0, 0 }, num_sizes = 0;
+    const char* scaling_mode = NULL;
+    int bad = 0;
+
+    // Parse command line options (every rank parses the same argv)
+    int opt;
+    while ((opt = getopt(argc, argv, "d:n:m:i:t:H:b:c:e:C:o:S:")) != -1) {
+        switch (opt) {
+        case 'd': cfg.ndims = atoi(optarg); break;
+        case 'n':
+            num_sizes = sscanf(optarg, "%d,%d,%d", &sizes[0], &sizes[1], &sizes[2]);
+            break;
+        case 'm':
+            if (strcmp(optarg, "jacobi") == 0) cfg.method = METHOD_JACOBI;
+            else if (strcmp(optarg, "rbgs") == 0) cfg.method = METHOD_RBGS;
+            else bad = 1;
+            break;
+        case 'i': cfg.iterations = atoi(optarg); break;
+        case 't': cfg.threads = atoi(optarg); break;
+        case 'H': cfg.halo = atoi(optarg); break;
+        case 'b': sscanf(optarg, "%d,%d", &cfg.tile[0], &cfg.tile[1]); break;
+        case 'c': cfg.check_every = atoi(optarg); break;
+        case 'e': cfg.tolerance = atof(optarg); break;
+        case 'C': cfg.checkpoint_every = atoi(optarg); break;
+        case 'o': cfg.prefix = optarg; break;
+        case 'S':
+            scaling_mode = optarg;
+            if (strcmp(optarg, "strong") != 0 && strcmp(optarg, "weak") != 0) bad = 1;
+            break;
+        default: bad = 1;
+        }
+    }
+    int side = cfg.ndims == 3 ? DEFAULT_3D : DEFAULT_2D;
+    for (int d = 0; d < 3; d++) {
+        cfg.global[d] = d >= cfg.ndims ? 1 : num_sizes > 0 ? sizes[d < num_sizes ? d : num_sizes - 1] : side;
+    }
+    if (bad || (cfg.ndims != 2 && cfg.ndims != 3) || cfg.global[0] < 1 || cfg.global[1] < 1 || cfg.global[2] < 1 ||
+        cfg.iterations < 1 || cfg.threads < 1 || cfg.threads > MAX_THREADS || cfg.halo < 1 || cfg.tile[0] < 0 ||
+        cfg.tile[1] < 0 || cfg.check_every < 0 || cfg.checkpoint_every < 0) {
+        if (world_rank == 0) usage(argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+    if (provided < MPI_THREAD_FUNNELED && cfg.threads > 1 && world_rank == 0)
+        fprintf(stderr, "Warning: MPI library does not provide MPI_THREAD_FUNNELED\n");
+
+    if (scaling_mode != NULL)
+        scaling(&cfg, strcmp(scaling_mode, "weak") == 0, world_rank, world_size);
+    else
+        solveOnce(&cfg, world_rank);
+
+    MPI_Finalize();
+    return 0;
+}
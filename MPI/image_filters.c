@@ -0,0 +1,710 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <mpi.h>
+
+#include "image_kernels.h"
+#include "ppm_image.h"
+#include "splitmix64.h"
+
+/*
+    Image filter pipeline (MPI + threads + SIMD) on 8-bit PGM/PPM images.
+
+    A chain of filters (-f blur:1.5,sobel) runs over an input image (-i) or a
+    synthetic test image, and the result can be written back as PGM/PPM (-o):
+        blur:sigma   separable Gaussian, radius ceil(3 sigma)
+        box:radius   separable box (mean of a (2r+1)^2 square)
+        sobel        gradient magnitude sqrt(gx^2 + gy^2) of the 3 x 3 Sobel operators
+    Every channel is filtered on its own, pixels outside the image repeat the
+    nearest edge pixel, and the result is rounded and clamped to 0..255.
+
+    Decomposition: every rank owns a band of rows, read and written with
+    collective MPI-IO (ppm_image.h) and kept as float planes with halo rows
+    above and below and padding columns left and right. Inside a rank,
+    pthreads split the rows; only thread 0 calls MPI. The halo rows are
+    exchanged with MPI_Isend/Irecv while the threads filter the rows that
+    need no halo data, the rows near the band edges follow after MPI_Waitall.
+
+    Fusion: a chain of radii r1, r2, ... needs a halo of r1 + r2 + ... rows,
+    exchanged once. The filters are not run one image pass after the other;
+    every thread streams its rows through the whole chain instead. Each filter
+    keeps its latest output rows in a ring of 2r + 1 rows (r of the next
+    filter), and asking for a row of the last filter pulls just the rows it
+    needs through the earlier ones, so no intermediate image is ever stored.
+    Each filter computes its vertical pass into one temporary row and its
+    horizontal pass straight into the ring. -u runs the unfused baseline: one
+    full image pass per filter, with its own halo exchange.
+
+    Cache tiling (-b width): the chain runs over vertical strips of `width`
+    columns, each filter recomputing the columns the later ones reach beyond
+    the strip, so the rings stay small enough for the L2 cache on wide images.
+
+    The fused, unfused, tiled and threaded runs do the same arithmetic in the
+    same order per pixel, so the checksum is the same for any -np, -t, -b or -u.
+
+    ispc -O2 --opt=disable-fma image.ispc -o image_ispc.o -h image_ispc.h
+    mpicc -O2 -ffp-contract=off -DUSE_ISPC image_filters.c image_ispc.o -o image_filters -lpthread -lm
+    mpirun -np 4 ./image_filters [-i input.ppm] [-o output.ppm] [-n width,height] [-c 1|3] [-f chain]
+                                 [-t threads] [-b width] [-u] [-r repeats]
+*/
+
+#define DEFAULT_WIDTH 3840
+#define DEFAULT_HEIGHT 2160
+#define DEFAULT_CHAIN "blur:1.5,sobel"
+#define DEFAULT_REPEATS 3
+#define MAX_STAGES 16
+#define MAX_RADIUS 32
+#define MAX_THREADS 256
+
+typedef enum { FILTER_BLUR, FILTER_BOX, FILTER_SOBEL } filter_kind;
+
+typedef struct {
+    filter_kind kind;
+    float param;                            // sigma (blur) or radius (box)
+    int radius;
+    float weights[2 * MAX_RADIUS + 1];      // taps of both passes (blur and box)
+} filter_stage;
+
+static const float SOBEL_SMOOTH[3] = { 1.0f, 2.0f, 1.0f };
+static const float SOBEL_DIFF[3] = { -1.0f, 0.0f, 1.0f };
+
+typedef struct {
+    const char* input;      // NULL = synthetic image
+    const char* output;     // NULL = no output file
+    int width, height;      // synthetic image size
+    int channels;
+    filter_stage stages[MAX_STAGES];
+    int num_stages;
+    int threads;
+    int tile;               // strip width in columns, 0 = whole rows
+    int fused;
+    int repeats;
+} filter_config;
+
+// Float planes of a band of rows: row y holds `channels` planes of `stride` floats, column 0 at `pad`
+typedef struct {
+    int rows;               // owned rows
+    int halo;               // rows above and below
+    int pad;                // columns left and right
+    int channels;
+    size_t stride;          // width + 2 pad
+    float* data;
+} local_image;
+
+typedef struct {
+    filter_config cfg;
+    int rank, size;
+    int width, height, channels;
+    int start, n;           // owned rows
+    int up, down;           // neighbor ranks, MPI_PROC_NULL at the image edges
+    local_image src;
+    local_image tmp[2];     // intermediate images of the unfused baseline
+    unsigned char* out;     // owned rows of the result, interleaved bytes
+
+    // thread coordination
+    pthread_barrier_t barrier;
+    MPI_Request requests[4];
+    double exchange_time;   // thread 0 time in MPI calls, all repetitions
+    double best;            // fastest repetition (slowest rank)
+} image_pipeline;
+
+// Per-thread state of the chain being run: rings, temporary rows and the current strip
+typedef struct {
+    image_pipeline* ip;
+    int tid;
+    float* ring[MAX_STAGES];        // latest output rows of every filter but the last
+    int ring_rows[MAX_STAGES];
+    float* temp[2];                 // vertical pass results
+    float* sink_row;                // output row of the last filter
+
+    const filter_stage* stages;     // chain being run
+    int count;
+    const local_image* src;
+    local_image* dst;               // NULL = bytes into ip->out
+    int x0, x1;                     // current strip
+    int origin[MAX_STAGES];         // first column held by the output rows of filter j
+    int span[MAX_STAGES];           // columns held, the strip plus what the later filters reach beyond it
+    int next_row[MAX_STAGES];       // next row filter j produces
+} filter_thread;
+
+// Function to get the first row and count of block `rank` out of `size` over n rows
+static void blockRange(int n, int size, int rank, int* start, int* count) {
+    int base = n / size, extra = n % size;
+    *start = rank * base + (rank < extra ? rank : extra);
+    *count = base + (rank < extra ? 1 : 0);
+}
+
+static inline int clampInt(int v, int lo, int hi) {
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+// Function to parse one filter of the chain ("blur:1.5", "box:2", "sobel"); returns 0 if invalid
+static int parseFilter(const char* spec, filter_stage* st) {
+    memset(st, 0, sizeof(*st));
+    const char* colon = strchr(spec, ':');
+    size_t name_len = colon ? (size_t)(colon - spec) : strlen(spec);
+    double param = colon ? atof(colon + 1) : 0;
+
+    if (name_len == 4 && strncmp(spec, "blur", 4) == 0 && param > 0) {
+        st->kind = FILTER_BLUR;
+        st->radius = (int)ceil(3 * param);
+        if (st->radius > MAX_RADIUS)
+            return 0;
+        double w[2 * MAX_RADIUS + 1], sum = 0;
+        for (int k = -st->radius; k <= st->radius; k++) {
+            w[k + st->radius] = exp(-(double)k * k / (2 * param * param));
+            sum += w[k + st->radius];
+        }
+        for (int k = 0; k <= 2 * st->radius; k++)
+            st->weights[k] = (float)(w[k] / sum);
+    } else if (name_len == 3 && strncmp(spec, "box", 3) == 0 && param >= 1 && param == (int)param) {
+        st->kind = FILTER_BOX;
+        st->radius = (int)param;
+        if (st->radius > MAX_RADIUS)
+            return 0;
+        for (int k = 0; k <= 2 * st->radius; k++)
+            st->weights[k] = 1.0f / (2 * st->radius + 1);
+    } else if (name_len == 5 && strncmp(spec, "sobel", 5) == 0 && colon == NULL) {
+        st->kind = FILTER_SOBEL;
+        st->radius = 1;
+    } else {
+        return 0;
+    }
+    st->param = (float)param;
+    return 1;
+}
+
+// Function to parse a comma-separated chain into cfg->stages; returns 0 if any filter is invalid
+static int parseChain(const char* chain, filter_config* cfg) {
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%s", chain);
+    cfg->num_stages = 0;
+    for (char* spec = strtok(buffer, ","); spec != NULL; spec = strtok(NULL, ",")) {
+        if (cfg->num_stages == MAX_STAGES || !parseFilter(spec, &cfg->stages[cfg->num_stages]))
+            return 0;
+        cfg->num_stages++;
+    }
+    return cfg->num_stages > 0;
+}
+
+static void printFilter(const filter_stage* st) {
+    if (st->kind == FILTER_BLUR)
+        printf("blur(sigma %g, radius %d)", st->param, st->radius);
+    else if (st->kind == FILTER_BOX)
+        printf("box(radius %d)", st->radius);
+    else
+        printf("sobel");
+}
+
+// Pointer to column 0 of local row y (-halo <= y < rows + halo), channel 0
+static inline float* imageRowPtr(const local_image* img, int y) {
+    return img->data + (size_t)(y + img->halo) * img->channels * img->stride + img->pad;
+}
+
+static void createImage(local_image* img, int rows, int halo, int pad, int width, int channels) {
+    img->rows = rows;
+    img->halo = halo;
+    img->pad = pad;
+    img->channels = channels;
+    img->stride = (size_t)width + 2 * pad;
+    img->data = (float*)malloc((size_t)(rows + 2 * halo) * channels * img->stride * sizeof(float));
+    if (img->data == NULL) {
+        fprintf(stderr, "Image allocation failed (%d rows of %d x %d)\n", rows + 2 * halo, width, channels);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+}
+
+// Function to repeat the edge pixels of local row y into its padding columns
+static void fillPads(local_image* img, int y, int width) {
+    float* row = imageRowPtr(img, y);
+    for (int c = 0; c < img->channels; c++) {
+        float* p = row + c * img->stride;
+        for (int x = 1; x <= img->pad; x++) {
+            p[-x] = p[0];
+            p[width - 1 + x] = p[width - 1];
+        }
+    }
+}
+
+// Function to generate the synthetic test image: 64-pixel checkerboard, a gradient per channel and some noise
+static void generateImage(image_pipeline* ip) {
+    for (int y = 0; y < ip->n; y++) {
+        int gy = ip->start + y;
+        float* row = imageRowPtr(&ip->src, y);
+        for (int c = 0; c < ip->channels; c++) {
+            for (int x = 0; x < ip->width; x++) {
+                int value = ((x >> 6) + (gy >> 6)) & 1 ? 176 : 64;
+                value += (int)(48.0 * (c + 1) * x / ip->width) - 24 * c;
+                uint64_t index = ((uint64_t)gy * ip->width + x) * ip->channels + c;
+                value += (int)(mix64(index) & 31) - 16;
+                row[c * ip->src.stride + x] = (float)clampInt(value, 0, 255);
+            }
+        }
+        fillPads(&ip->src, y, ip->width);
+    }
+}
+
+// Function to load the owned rows of the input file; returns 0 on every rank if the read failed
+static int loadImage(image_pipeline* ip, const pnm_header* header) {
+    size_t row_bytes = (size_t)ip->width * ip->channels;
+    unsigned char* pixels = (unsigned char*)malloc(ip->n * row_bytes + 1);
+    if (pixels == NULL) {
+        fprintf(stderr, "Process %d: input buffer allocation failed\n", ip->rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    int ok = readPNMRowsMPI(ip->cfg.input, header, ip->start, ip->n, pixels, MPI_COMM_WORLD);
+    for (int y = 0; ok && y < ip->n; y++) {
+        const unsigned char* p = pixels + y * row_bytes;
+        float* row = imageRowPtr(&ip->src, y);
+        for (int x = 0; x < ip->width; x++) {
+            for (int c = 0; c < ip->channels; c++)
+                row[c * ip->src.stride + x] = p[x * ip->channels + c];
+        }
+        fillPads(&ip->src, y, ip->width);
+    }
+    free(pixels);
+    return ok;
+}
+
+// Function to post the exchange of `rows` halo rows; messages to the rank above carry tag 1
+static void exchangeBegin(image_pipeline* ip, local_image* img, int rows) {
+    double start = MPI_Wtime();
+    size_t row_floats = (size_t)img->channels * img->stride;
+    int count = (int)(rows * row_floats);
+    float* base = imageRowPtr(img, 0) - img->pad;
+    MPI_Irecv(base - rows * row_floats, count, MPI_FLOAT, ip->up, 0, MPI_COMM_WORLD, &ip->requests[0]);
+    MPI_Irecv(base + ip->n * row_floats, count, MPI_FLOAT, ip->down, 1, MPI_COMM_WORLD, &ip->requests[1]);
+    MPI_Isend(base, count, MPI_FLOAT, ip->up, 1, MPI_COMM_WORLD, &ip->requests[2]);
+    MPI_Isend(base + (ip->n - rows) * row_floats, count, MPI_FLOAT, ip->down, 0, MPI_COMM_WORLD, &ip->requests[3]);
+    ip->exchange_time += MPI_Wtime() - start;
+}
+
+static void exchangeEnd(image_pipeline* ip) {
+    double start = MPI_Wtime();
+    MPI_Waitall(4, ip->requests, MPI_STATUSES_IGNORE);
+    ip->exchange_time += MPI_Wtime() - start;
+}
+
+// Pointer to column col of input row y (clamped to the image) of filter j of the chain, and its channel stride
+static const float* stageInput(const filter_thread* ft, int j, int y, int col, size_t* stride) {
+    int yc = clampInt(y, 0, ft->ip->height - 1);
+    if (j == 0) {
+        *stride = ft->src->stride;
+        return imageRowPtr(ft->src, yc - ft->ip->start) + col;
+    }
+    *stride = ft->span[j - 1];
+    return ft->ring[j - 1] + (size_t)(yc % ft->ring_rows[j - 1]) * ft->ip->channels * ft->span[j - 1] +
+           (col - ft->origin[j - 1]);
+}
+
+// Function to hand a finished row of the last filter to the output image or the next pass
+static void sinkRow(filter_thread* ft, int y) {
+    image_pipeline* ip = ft->ip;
+    int len = ft->x1 - ft->x0, span = ft->span[ft->count - 1];
+    if (ft->dst != NULL) {
+        float* row = imageRowPtr(ft->dst, y - ip->start);
+        for (int c = 0; c < ip->channels; c++)
+            memcpy(row + c * ft->dst->stride + ft->x0, ft->sink_row + c * span, len * sizeof(float));
+        if (ft->x1 == ip->width)
+            fillPads(ft->dst, y - ip->start, ip->width);
+        return;
+    }
+    unsigned char* out = ip->out + ((size_t)(y - ip->start) * ip->width + ft->x0) * ip->channels;
+    for (int x = 0; x < len; x++) {
+        for (int c = 0; c < ip->channels; c++) {
+            float v = ft->sink_row[c * span + x];
+            out[x * ip->channels + c] = v <= 0 ? 0 : v >= 255 ? 255 : (unsigned char)(v + 0.5f);
+        }
+    }
+}
+
+static void ensureRows(filter_thread* ft, int j, int y);
+
+/*
+    Function to compute row y of filter j of the chain over the columns held
+    by its output rows: the rows it reads are pulled through the earlier filters
+    first, columns outside the image repeat the edge pixel.
+*/
+static void produceRow(filter_thread* ft, int j, int y) {
+    const filter_stage* st = &ft->stages[j];
+    image_pipeline* ip = ft->ip;
+    int r = st->radius, taps = 2 * r + 1;
+    if (j > 0)
+        ensureRows(ft, j - 1, y + r < ip->height - 1 ? y + r : ip->height - 1);
+
+    int lo = ft->origin[j] > 0 ? ft->origin[j] : 0;
+    int hi = ft->origin[j] + ft->span[j] < ip->width ? ft->origin[j] + ft->span[j] : ip->width;
+    int vlen = hi - lo + 2 * r;     // the vertical pass covers the horizontal taps
+    size_t span = ft->span[j];
+    float* out = j == ft->count - 1 ? ft->sink_row : ft->ring[j] + (size_t)(y % ft->ring_rows[j]) * ip->channels * span;
+
+    const float* in[2 * MAX_RADIUS + 1];
+    size_t in_stride = 0;
+    for (int k = 0; k < taps; k++)
+        in[k] = stageInput(ft, j, y - r + k, lo - r, &in_stride);
+
+    for (int c = 0; c < ip->channels; c++) {
+        const float* rows[2 * MAX_RADIUS + 1];
+        for (int k = 0; k < taps; k++)
+            rows[k] = in[k] + c * in_stride;
+        float* o = out + c * span;
+        int first = lo - ft->origin[j], last = hi - 1 - ft->origin[j];
+        if (st->kind == FILTER_SOBEL) {
+            imageColumn(vlen, 3, SOBEL_SMOOTH, rows, ft->temp[0]);
+            imageColumn(vlen, 3, SOBEL_DIFF, rows, ft->temp[1]);
+            imageSobel(hi - lo, ft->temp[0] + 1, ft->temp[1] + 1, o + first);
+        } else {
+            imageColumn(vlen, taps, st->weights, rows, ft->temp[0]);
+            imageRow(hi - lo, taps, st->weights, ft->temp[0], o + first);
+        }
+        for (int x = 0; x < first; x++)
+            o[x] = o[first];
+        for (int x = last + 1; x < (int)span; x++)
+            o[x] = o[last];
+    }
+    if (j == ft->count - 1)
+        sinkRow(ft, y);
+}
+
+// Function to let filter j produce its rows up to y
+static void ensureRows(filter_thread* ft, int j, int y) {
+    while (ft->next_row[j] <= y)
+        produceRow(ft, j, ft->next_row[j]++);
+}
+
+// Function to run the chain over rows [y0, y1) and columns [x0, x1)
+static void runStrip(filter_thread* ft, int y0, int y1, int x0, int x1) {
+    ft->x0 = x0;
+    ft->x1 = x1;
+    for (int j = ft->count - 1, below = 0; j >= 0; below += ft->stages[j].radius, j--) {
+        ft->origin[j] = x0 - below;
+        ft->span[j] = x1 - x0 + 2 * below;
+        ft->next_row[j] = y0 - below > 0 ? y0 - below : 0;
+    }
+    for (int y = y0; y < y1; y++)
+        ensureRows(ft, ft->count - 1, y);
+}
+
+// Function to run this thread's share of rows [y0, y1), strip by strip
+static void runRows(filter_thread* ft, int y0, int y1) {
+    image_pipeline* ip = ft->ip;
+    int len = y1 - y0;
+    int first = y0 + (int)((long long)len * ft->tid / ip->cfg.threads);
+    int last = y0 + (int)((long long)len * (ft->tid + 1) / ip->cfg.threads);
+    if (first >= last)
+        return;
+    int bx = ip->cfg.tile > 0 ? ip->cfg.tile : ip->width;
+    for (int x0 = 0; x0 < ip->width; x0 += bx)
+        runStrip(ft, first, last, x0, x0 + bx < ip->width ? x0 + bx : ip->width);
+}
+
+/*
+    Function to run `count` filters from `stages` over the owned rows of src
+    (all threads together). The rows that read no halo row are filtered while
+    thread 0 exchanges the halo, the rows near the band edges afterwards.
+*/
+static void runChain(filter_thread* ft, const filter_stage* stages, int count, local_image* src, local_image* dst) {
+    image_pipeline* ip = ft->ip;
+    int halo = 0;
+    for (int j = 0; j < count; j++)
+        halo += stages[j].radius;
+    ft->stages = stages;
+    ft->count = count;
+    ft->src = src;
+    ft->dst = dst;
+
+    if (ft->tid == 0)
+        exchangeBegin(ip, src, halo);
+    int end = ip->start + ip->n;
+    int lo = ip->start == 0 ? 0 : ip->start + halo;
+    int hi = end == ip->height ? end : end - halo;
+    if (lo > end) lo = end;
+    if (hi < lo) hi = lo;
+    runRows(ft, lo, hi);
+    if (ft->tid == 0)
+        exchangeEnd(ip);
+    pthread_barrier_wait(&ip->barrier);
+    runRows(ft, ip->start, lo);
+    runRows(ft, hi, end);
+    pthread_barrier_wait(&ip->barrier);
+}
+
+// Per-thread loop over the timed repetitions; thread 0 also does the MPI work
+static void* filterThread(void* arg) {
+    filter_thread* ft = (filter_thread*)arg;
+    image_pipeline* ip = ft->ip;
+    const filter_config* cfg = &ip->cfg;
+    for (int rep = 0; rep < cfg->repeats; rep++) {
+        double start = 0;
+        if (ft->tid == 0) {
+            MPI_Barrier(MPI_COMM_WORLD);
+            start = MPI_Wtime();
+        }
+        pthread_barrier_wait(&ip->barrier);
+        if (cfg->fused) {
+            runChain(ft, cfg->stages, cfg->num_stages, &ip->src, NULL);
+        } else {
+            local_image* src = &ip->src;
+            for (int s = 0; s < cfg->num_stages; s++) {
+                local_image* dst = s == cfg->num_stages - 1 ? NULL : &ip->tmp[s & 1];
+                runChain(ft, &cfg->stages[s], 1, src, dst);
+                src = dst;
+            }
+        }
+        if (ft->tid == 0) {
+            double elapsed = MPI_Wtime() - start, slowest;
+            MPI_Allreduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+            if (rep == 0 || slowest < ip->best)
+                ip->best = slowest;
+        }
+    }
+    return NULL;
+}
+
+// Function to allocate the rings and temporary rows of one thread
+static void createThread(filter_thread* ft, image_pipeline* ip, int tid, int halo) {
+    const filter_config* cfg = &ip->cfg;
+    memset(ft, 0, sizeof(*ft));
+    ft->ip = ip;
+    ft->tid = tid;
+    int bx = cfg->tile > 0 && cfg->tile < ip->width ? cfg->tile : ip->width;
+    int ok = 1;
+    if (cfg->fused) {
+        // ring j feeds filter j + 1 and holds the columns of all later filters
+        for (int j = 0, below = halo; j < cfg->num_stages - 1; j++) {
+            below -= cfg->stages[j].radius;
+            ft->ring_rows[j] = 2 * cfg->stages[j + 1].radius + 1;
+            ft->ring[j] = (float*)malloc((size_t)ft->ring_rows[j] * ip->channels * (bx + 2 * below) * sizeof(float));
+            ok = ok && ft->ring[j] != NULL;
+        }
+    }
+    for (int t = 0; t < 2; t++) {
+        ft->temp[t] = (float*)malloc((size_t)(bx + 2 * halo + 2) * sizeof(float));
+        ok = ok && ft->temp[t] != NULL;
+    }
+    ft->sink_row = (float*)malloc((size_t)ip->channels * bx * sizeof(float));
+    if (!ok || ft->sink_row == NULL) {
+        fprintf(stderr, "Process %d: line buffer allocation failed\n", ip->rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+}
+
+static void destroyThread(filter_thread* ft) {
+    for (int j = 0; j < MAX_STAGES; j++)
+        free(ft->ring[j]);
+    free(ft->temp[0]);
+    free(ft->temp[1]);
+    free(ft->sink_row);
+}
+
+// Function to run the repetitions on all threads; sets ip->best
+static void runPipeline(image_pipeline* ip, int halo) {
+    pthread_t threads[MAX_THREADS];
+    filter_thread* args = (filter_thread*)malloc(ip->cfg.threads * sizeof(filter_thread));
+    if (args == NULL) {
+        fprintf(stderr, "Process %d: thread state allocation failed\n", ip->rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    for (int t = 0; t < ip->cfg.threads; t++)
+        createThread(&args[t], ip, t, halo);
+    for (int t = 1; t < ip->cfg.threads; t++) {
+        if (pthread_create(&threads[t], NULL, filterThread, &args[t]) != 0) {
+            fprintf(stderr, "Process %d: failed to create thread %d\n", ip->rank, t);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    filterThread(&args[0]);
+    for (int t = 1; t < ip->cfg.threads; t++)
+        pthread_join(threads[t], NULL);
+    for (int t = 0; t < ip->cfg.threads; t++)
+        destroyThread(&args[t]);
+    free(args);
+}
+
+// Function to hash every output byte with its global index; the sum does not depend on the decomposition
+static uint64_t imageChecksum(const image_pipeline* ip) {
+    size_t row_bytes = (size_t)ip->width * ip->channels;
+    uint64_t local = 0, global = 0;
+    for (int y = 0; y < ip->n; y++) {
+        const unsigned char* row = ip->out + y * row_bytes;
+        uint64_t base = (uint64_t)(ip->start + y) * row_bytes;
+        for (size_t i = 0; i < row_bytes; i++)
+            local += mix64((base + i) << 8 | row[i]);
+    }
+    MPI_Allreduce(&local, &global, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+    return global;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [options]\n", prog);
+    fprintf(stderr, "  -i file          input PGM (P5) or PPM (P6), default a synthetic image\n");
+    fprintf(stderr, "  -o file          write the result (PGM or PPM like the input)\n");
+    fprintf(stderr, "  -n width,height  synthetic image size, default %d,%d\n", DEFAULT_WIDTH, DEFAULT_HEIGHT);
+    fprintf(stderr, "  -c 1|3           synthetic image channels, default 3\n");
+    fprintf(stderr, "  -f chain         comma-separated blur:sigma, box:radius and sobel, default %s\n",
+            DEFAULT_CHAIN);
+    fprintf(stderr, "  -t threads       threads per process, default 1\n");
+    fprintf(stderr, "  -b width         run the chain over strips of this many columns, default whole rows\n");
+    fprintf(stderr, "  -u               unfused: one full image pass per filter\n");
+    fprintf(stderr, "  -r repeats       timed runs, the fastest is reported, default %d\n", DEFAULT_REPEATS);
+}
+
+int main(int argc, char* argv[]) {
+    int provided, rank, size;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    filter_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.width = DEFAULT_WIDTH;
+    cfg.height = DEFAULT_HEIGHT;
+    cfg.channels = 3;
+    cfg.threads = 1;
+    cfg.fused = 1;
+    cfg.repeats = DEFAULT_REPEATS;
+    const char* chain = DEFAULT_CHAIN;
+    int bad = 0;
+
+    // Parse command line options (every rank parses the same argv)
+    int opt;
+    while ((opt = getopt(argc, argv, "i:o:n:c:f:t:b:ur:")) != -1) {
+        switch (opt) {
+        case 'i': cfg.input = optarg; break;
+        case 'o': cfg.output = optarg; break;
+        case 'n':
+            if (sscanf(optarg, "%d,%d", &cfg.width, &cfg.height) != 2) bad = 1;
+            break;
+        case 'c': cfg.channels = atoi(optarg); break;
+        case 'f': chain = optarg; break;
+        case 't': cfg.threads = atoi(optarg); break;
+        case 'b': cfg.tile = atoi(optarg); break;
+        case 'u': cfg.fused = 0; break;
+        case 'r': cfg.repeats = atoi(optarg); break;
+        default: bad = 1;
+        }
+    }
+    if (bad || !parseChain(chain, &cfg) || cfg.width < 1 || cfg.height < 1 ||
+        (cfg.channels != 1 && cfg.channels != 3) || cfg.threads < 1 || cfg.threads > MAX_THREADS ||
+        cfg.tile < 0 || cfg.repeats < 1) {
+        if (rank == 0) usage(argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+    if (provided < MPI_THREAD_FUNNELED && cfg.threads > 1 && rank == 0)
+        fprintf(stderr, "Warning: MPI library does not provide MPI_THREAD_FUNNELED\n");
+
+    image_pipeline ip;
+    memset(&ip, 0, sizeof(ip));
+    ip.cfg = cfg;
+    ip.rank = rank;
+    ip.size = size;
+    pnm_header header = { 0, 0, 0, 0 };
+    if (cfg.input != NULL) {
+        if (!readPNMHeaderMPI(cfg.input, &header, MPI_COMM_WORLD)) {
+            MPI_Finalize();
+            return 1;
+        }
+        ip.width = header.width;
+        ip.height = header.height;
+        ip.channels = header.channels;
+    } else {
+        ip.width = cfg.width;
+        ip.height = cfg.height;
+        ip.channels = cfg.channels;
+    }
+    blockRange(ip.height, size, rank, &ip.start, &ip.n);
+    ip.up = rank > 0 ? rank - 1 : MPI_PROC_NULL;
+    ip.down = rank < size - 1 ? rank + 1 : MPI_PROC_NULL;
+
+    // fused: one halo for the whole chain, unfused: the widest filter
+    int total = 0, widest = 0;
+    for (int s = 0; s < cfg.num_stages; s++) {
+        total += cfg.stages[s].radius;
+        widest = cfg.stages[s].radius > widest ? cfg.stages[s].radius : widest;
+    }
+    int halo = cfg.fused ? total : widest;
+    int ok = size == 1 || ip.n >= halo;
+    MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+    if (!ok) {
+        if (rank == 0)
+            fprintf(stderr, "Every process needs at least %d image rows (the halo of the chain)\n", halo);
+        MPI_Finalize();
+        return 1;
+    }
+
+    createImage(&ip.src, ip.n, halo, halo, ip.width, ip.channels);
+    for (int t = 0; !cfg.fused && t < 2 && t < cfg.num_stages - 1; t++)
+        createImage(&ip.tmp[t], ip.n, halo, halo, ip.width, ip.channels);
+    ip.out = (unsigned char*)malloc((size_t)ip.n * ip.width * ip.channels + 1);
+    if (ip.out == NULL) {
+        fprintf(stderr, "Process %d: output buffer allocation failed\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start = MPI_Wtime();
+    if (cfg.input != NULL) {
+        if (!loadImage(&ip, &header)) {
+            if (rank == 0)
+                fprintf(stderr, "Error: reading '%s' failed\n", cfg.input);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    } else {
+        generateImage(&ip);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    double read_time = MPI_Wtime() - start;
+
+    if (rank == 0) {
+        printf("Image %d x %d, %d channel%s (%s), %d processes, %d threads each", ip.width, ip.height, ip.channels,
+               ip.channels > 1 ? "s" : "", cfg.input ? cfg.input : "synthetic", size, cfg.threads);
+        if (cfg.tile > 0)
+            printf(", strips of %d columns", cfg.tile);
+        printf("\nChain: ");
+        for (int s = 0; s < cfg.num_stages; s++) {
+            if (s > 0) printf(" -> ");
+            printFilter(&cfg.stages[s]);
+        }
+        printf(", %s, halo %d rows\n", cfg.fused ? "fused" : "unfused", halo);
+    }
+
+    pthread_barrier_init(&ip.barrier, NULL, cfg.threads);
+    runPipeline(&ip, halo);
+    pthread_barrier_destroy(&ip.barrier);
+
+    double exchange = 0;
+    MPI_Reduce(&ip.exchange_time, &exchange, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    uint64_t checksum = imageChecksum(&ip);
+
+    double write_time = 0;
+    if (cfg.output != NULL) {
+        start = MPI_Wtime();
+        ok = writePNMImageMPI(ip.out, ip.start, ip.n, ip.width, ip.height, ip.channels, cfg.output, MPI_COMM_WORLD);
+        write_time = MPI_Wtime() - start;
+        if (rank == 0 && ok)
+            printf("Image written to %s\n", cfg.output);
+    }
+
+    if (rank == 0) {
+        double megapixels = (double)ip.width * ip.height / 1e6;
+        printf("Filter: best of %d in %.4f s, %.1f MP/s (%.1f MP/s per process), halo exchange on thread 0: %.4f s "
+               "per run\n", cfg.repeats, ip.best, megapixels / ip.best, megapixels / ip.best / size,
+               exchange / cfg.repeats);
+        printf("%s %.3f s", cfg.input ? "Read" : "Generate", read_time);
+        if (cfg.output != NULL)
+            printf(", write %.3f s", write_time);
+        printf("\nChecksum %016llx (same for any -np, -t, -b and -u)\n", (unsigned long long)checksum);
+    }
+
+    free(ip.src.data);
+    free(ip.tmp[0].data);
+    free(ip.tmp[1].data);
+    free(ip.out);
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,72 @@
+// image_kernels.h
+// Row kernels of image_filters.c: one channel row of a separable filter pass or of the Sobel magnitude
+#ifndef IMAGE_KERNELS_H
+#define IMAGE_KERNELS_H
+
+#include <math.h>
+
+#ifdef USE_ISPC
+#include "image_ispc.h"
+#endif
+
+/*
+    A separable filter is a vertical pass followed by a horizontal pass, both
+    run one row at a time:
+        imageColumn  out[i] = sum_k weights[k] * rows[k][i]   (taps input rows)
+        imageRow     out[i] = sum_k weights[k] * in[i + k]    (in starts radius
+                                                               columns left of out)
+    Sobel smooths and differentiates vertically with imageColumn ({1, 2, 1} and
+    {-1, 0, 1}) and combines both rows horizontally in imageSobel:
+        gx = smooth[i + 1] - smooth[i - 1]
+        gy = diff[i - 1] + 2 diff[i] + diff[i + 1]
+        out[i] = sqrt(gx^2 + gy^2)
+    smooth[-1], smooth[len], diff[-1] and diff[len] must be readable.
+
+    The C loops run tap by tap over the whole row so the compiler can
+    vectorize them (out must not alias the inputs); every pixel still adds its
+    taps in order, like the ISPC versions in image.ispc, so with
+    -ffp-contract=off / --opt=disable-fma the images are bit-identical.
+*/
+
+static inline void imageColumn(int len, int taps, const float* weights, const float* const* rows, float* out) {
+#ifdef USE_ISPC
+    image_column(len, taps, (float*)weights, (float**)rows, out);
+#else
+    for (int i = 0; i < len; i++)
+        out[i] = 0;
+    for (int k = 0; k < taps; k++) {
+        const float* row = rows[k];
+        float w = weights[k];
+        for (int i = 0; i < len; i++)
+            out[i] += w * row[i];
+    }
+#endif
+}
+
+static inline void imageRow(int len, int taps, const float* weights, const float* in, float* out) {
+#ifdef USE_ISPC
+    image_row(len, taps, (float*)weights, (float*)in, out);
+#else
+    for (int i = 0; i < len; i++)
+        out[i] = 0;
+    for (int k = 0; k < taps; k++) {
+        float w = weights[k];
+        for (int i = 0; i < len; i++)
+            out[i] += w * in[i + k];
+    }
+#endif
+}
+
+static inline void imageSobel(int len, const float* smooth, const float* diff, float* out) {
+#ifdef USE_ISPC
+    image_sobel(len, (float*)smooth, (float*)diff, out);
+#else
+    for (int i = 0; i < len; i++) {
+        float gx = smooth[i + 1] - smooth[i - 1];
+        float gy = diff[i - 1] + 2.0f * diff[i] + diff[i + 1];
+        out[i] = sqrtf(gx * gx + gy * gy);
+    }
+#endif
+}
+
+#endif
@@ -0,0 +1,566 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <unistd.h>
+#include <mpi.h>
+
+#include "philox.h"
+#include "kmeans_kernels.h"
+
+/*
+    Distributed K-Means (MPI + SIMD) with triangle-inequality pruning.
+
+    Every rank owns a contiguous shard of the n points, stored SoA
+    (x[d * count + i]) so the distance kernels in kmeans_kernels.h /
+    kmeans.ispc load one coordinate of many points per vector. Points are
+    drawn from `blobs` Gaussian clusters (unit spread, centers in [-10, 10]^d)
+    with Philox counted by the global point index, and the initial centroids
+    are the points at indices c * n / k, so the input and the start do not
+    depend on -np.
+
+    Each iteration assigns points to their nearest centroid, then moves every
+    centroid to the mean of its points:
+        lloyd    every point against every centroid (kmeansNearest)
+        hamerly  one upper bound (distance to the own centroid) and one lower
+                 bound (distance to the second nearest) per point; a point is
+                 only looked at when its upper bound exceeds
+                 max(lower bound, half the distance from its centroid to the
+                 nearest other centroid)
+        elkan    one lower bound per point and centroid; each centroid is
+                 skipped on its own when the bound or half the centroid-centroid
+                 distance rules it out
+    When centroids move by p[c], upper bounds grow by p[own] and lower bounds
+    shrink by p[c] (Hamerly: by the largest p), so after the first iterations
+    most points need no distance at all. The three methods give the same
+    clusters except where a point is equally far from two centroids: Lloyd
+    takes the lower index, the bounds keep the current one.
+
+    Per-rank centroid sums and counts are updated incrementally when a point
+    changes cluster. They go into one buffer together with the number of
+    changed points and distance evaluations, which is combined with a single
+    MPI_Allreduce per iteration; every rank then computes the same centroids.
+    The run stops when no point changes or after -i iterations.
+
+    -B sweeps k and the dimension for all three algorithms and prints
+    points/s per iteration and the share of Lloyd's distance evaluations.
+
+    ispc -O2 --opt=disable-fma kmeans.ispc -o kmeans_ispc.o -h kmeans_ispc.h
+    mpicc -O2 -ffp-contract=off -DUSE_ISPC kmeans.c kmeans_ispc.o -o kmeans -lm
+    mpirun -np 4 ./kmeans [-n points] [-d dims] [-k clusters] [-b blobs] [-a lloyd|hamerly|elkan]
+                          [-i iterations] [-s seed] [-q] [-B]
+*/
+
+#define DEFAULT_POINTS 1000000
+#define DEFAULT_DIMS 16
+#define DEFAULT_K 32
+#define DEFAULT_ITERATIONS 100
+#define DEFAULT_SEED 2024
+#define CENTER_RANGE 10.0
+
+typedef enum { ALG_LLOYD, ALG_HAMERLY, ALG_ELKAN } algorithm_t;
+
+typedef struct {
+    long long n;
+    int dims, k;
+    int blobs;              // Gaussian clusters in the data, 0 = k
+    algorithm_t algorithm;
+    int iterations;
+    uint64_t seed;
+    int quiet;              // no per-iteration output
+} kmeans_config;
+
+typedef struct {
+    kmeans_config cfg;
+    int rank, size;
+    long long first;        // global index of the first local point
+    int count;              // local points
+    float* x;               // SoA coordinates, x[d * count + i]
+    int* assign;
+    float* upper;           // distance bound to the own centroid (Lloyd: scratch)
+    float* lower;           // Hamerly: one per point, Elkan: k per point (Lloyd: scratch)
+    int* scratch;           // Lloyd: new assignments
+    float* centroids;       // k x dims
+    float* ct;              // dims x k
+    float* shift;           // how far each centroid moved in the last update
+    float* half_gap;        // half the distance to the nearest other centroid
+    float* cc;              // k x k centroid distances
+    float* point;           // one gathered point
+    float* dist;            // distances of one point to all centroids
+    double* local;          // sums (k x dims), counts (k), changed, distance evaluations
+    double* global;
+    int reduce_len;
+} kmeans;
+
+typedef struct {
+    int iterations;
+    double time;            // slowest rank
+    double distances;       // distance evaluations over all iterations
+    double sse;             // sum of squared distances to the own centroid
+} kmeans_result;
+
+static const char* algorithmName(algorithm_t a) {
+    switch (a) {
+    case ALG_HAMERLY: return "hamerly";
+    case ALG_ELKAN: return "elkan";
+    default: return "lloyd";
+    }
+}
+
+// Function to get the first point and count of block `rank` out of `size` over n points
+static void blockRange(long long n, int size, int rank, long long* first, int* count) {
+    long long base = n / size, rem = n % size;
+    *first = rank * base + (rank < rem ? rank : rem);
+    *count = (int)(base + (rank < rem ? 1 : 0));
+}
+
+// Function to draw 4 random words for (index, draw, experiment) from the seed
+static void randomWords(uint64_t seed, uint64_t index, uint32_t draw, uint32_t experiment, uint32_t out[4]) {
+    uint32_t counter[4] = { (uint32_t)index, (uint32_t)(index >> 32), draw, experiment };
+    uint32_t key[2] = { (uint32_t)seed, (uint32_t)(seed >> 32) };
+    philox4x32(counter, key, out);
+}
+
+// Function to generate point `index`: a blob center plus unit normal noise (Box-Muller)
+static void generatePoint(const kmeans_config* cfg, const float* centers, long long index, float* out) {
+    uint32_t r[4];
+    randomWords(cfg->seed, (uint64_t)index, 0xffffffffu, 2, r);
+    const float* center = centers + (size_t)(r[0] % (uint32_t)cfg->blobs) * cfg->dims;
+    for (int d = 0; d < cfg->dims; d += 2) {
+        randomWords(cfg->seed, (uint64_t)index, (uint32_t)(d / 2), 1, r);
+        double radius = sqrt(-2.0 * log(philoxUniform(r[0], r[1])));
+        double angle = 6.283185307179586 * philoxUniform(r[2], r[3]);
+        out[d] = center[d] + (float)(radius * cos(angle));
+        if (d + 1 < cfg->dims)
+            out[d + 1] = center[d + 1] + (float)(radius * sin(angle));
+    }
+}
+
+// Function to rebuild the transposed centroids and the centroid-centroid distances
+static void centroidGaps(kmeans* km) {
+    int k = km->cfg.k, dims = km->cfg.dims;
+    for (int c = 0; c < k; c++)
+        for (int d = 0; d < dims; d++)
+            km->ct[(size_t)d * k + c] = km->centroids[(size_t)c * dims + d];
+    if (km->cfg.algorithm == ALG_LLOYD)
+        return;
+    for (int c = 0; c < k; c++) {
+        float* row = km->cc + (size_t)c * k;
+        kmeansDistances(dims, k, km->ct, km->centroids + (size_t)c * dims, row);
+        float nearest = INFINITY;
+        for (int o = 0; o < k; o++)
+            if (o != c && row[o] < nearest)
+                nearest = row[o];
+        km->half_gap[c] = 0.5f * nearest;
+    }
+}
+
+// Function to move local point i from cluster `from` to `to` in the running sums
+static void movePoint(kmeans* km, int i, int from, int to) {
+    int dims = km->cfg.dims;
+    double* sums = km->local;
+    double* counts = km->local + (size_t)km->cfg.k * dims;
+    for (int d = 0; d < dims; d++) {
+        double v = km->x[(size_t)d * km->count + i];
+        if (from >= 0)
+            sums[(size_t)from * dims + d] -= v;
+        sums[(size_t)to * dims + d] += v;
+    }
+    if (from >= 0)
+        counts[from] -= 1.0;
+    counts[to] += 1.0;
+}
+
+static void gatherPoint(kmeans* km, int i) {
+    for (int d = 0; d < km->cfg.dims; d++)
+        km->point[d] = km->x[(size_t)d * km->count + i];
+}
+
+// Function to find the nearest and second nearest entry of km->dist (lowest index on ties)
+static int nearestOf(const kmeans* km, float* best, float* second) {
+    int a = 0;
+    *best = INFINITY;
+    *second = INFINITY;
+    for (int c = 0; c < km->cfg.k; c++) {
+        if (km->dist[c] < *best) {
+            *second = *best;
+            *best = km->dist[c];
+            a = c;
+        } else if (km->dist[c] < *second) {
+            *second = km->dist[c];
+        }
+    }
+    return a;
+}
+
+// Function to assign every point from scratch (first iteration); returns distance evaluations
+static double assignAll(kmeans* km) {
+    int k = km->cfg.k;
+    if (km->cfg.algorithm == ALG_ELKAN) {
+        for (int i = 0; i < km->count; i++) {
+            gatherPoint(km, i);
+            kmeansDistances(km->cfg.dims, k, km->ct, km->point, km->dist);
+            memcpy(km->lower + (size_t)i * k, km->dist, sizeof(float) * k);
+            float second;
+            km->assign[i] = nearestOf(km, &km->upper[i], &second);
+        }
+    } else {
+        kmeansNearest(km->count, km->cfg.dims, km->count, km->x, k, km->centroids, km->assign, km->upper,
+                      km->lower);
+    }
+    for (int i = 0; i < km->count; i++)
+        movePoint(km, i, -1, km->assign[i]);
+    return (double)km->count * k;
+}
+
+static void lloydStep(kmeans* km, double* changed, double* evaluations) {
+    kmeansNearest(km->count, km->cfg.dims, km->count, km->x, km->cfg.k, km->centroids, km->scratch, km->upper,
+                  km->lower);
+    for (int i = 0; i < km->count; i++) {
+        if (km->scratch[i] != km->assign[i]) {
+            movePoint(km, i, km->assign[i], km->scratch[i]);
+            km->assign[i] = km->scratch[i];
+            *changed += 1;
+        }
+    }
+    *evaluations += (double)km->count * km->cfg.k;
+}
+
+static void hamerlyStep(kmeans* km, double* changed, double* evaluations) {
+    int k = km->cfg.k, dims = km->cfg.dims;
+    // lower bounds drop by the largest shift, or the second largest for points of the largest mover
+    int far = 0;
+    float max_shift = 0.0f, second_shift = 0.0f;
+    for (int c = 0; c < k; c++) {
+        if (km->shift[c] > max_shift) {
+            second_shift = max_shift;
+            max_shift = km->shift[c];
+            far = c;
+        } else if (km->shift[c] > second_shift) {
+            second_shift = km->shift[c];
+        }
+    }
+    for (int i = 0; i < km->count; i++) {
+        int a = km->assign[i];
+        km->upper[i] += km->shift[a];
+        km->lower[i] -= a == far ? second_shift : max_shift;
+        float bound = fmaxf(km->half_gap[a], km->lower[i]);
+        if (km->upper[i] <= bound)
+            continue;
+        km->upper[i] = kmeansDistance(dims, km->count, km->x, i, km->centroids + (size_t)a * dims);
+        *evaluations += 1;
+        if (km->upper[i] <= bound)
+            continue;
+        gatherPoint(km, i);
+        kmeansDistances(dims, k, km->ct, km->point, km->dist);
+        *evaluations += k;
+        int b = nearestOf(km, &km->upper[i], &km->lower[i]);
+        if (b != a) {
+            movePoint(km, i, a, b);
+            km->assign[i] = b;
+            *changed += 1;
+        }
+    }
+}
+
+static void elkanStep(kmeans* km, double* changed, double* evaluations) {
+    int k = km->cfg.k, dims = km->cfg.dims;
+    for (int i = 0; i < km->count; i++) {
+        float* lower = km->lower + (size_t)i * k;
+        for (int c = 0; c < k; c++)
+            lower[c] = fmaxf(0.0f, lower[c] - km->shift[c]);
+        int a = km->assign[i];
+        float u = km->upper[i] + km->shift[a];
+        if (u > km->half_gap[a]) {
+            int stale = 1;
+            for (int c = 0; c < k; c++) {
+                if (c == a || u <= lower[c] || u <= 0.5f * km->cc[(size_t)a * k + c])
+                    continue;
+                if (stale) {
+                    u = kmeansDistance(dims, km->count, km->x, i, km->centroids + (size_t)a * dims);
+                    lower[a] = u;
+                    stale = 0;
+                    *evaluations += 1;
+                    if (u <= lower[c] || u <= 0.5f * km->cc[(size_t)a * k + c])
+                        continue;
+                }
+                float dc = kmeansDistance(dims, km->count, km->x, i, km->centroids + (size_t)c * dims);
+                lower[c] = dc;
+                *evaluations += 1;
+                if (dc < u) {
+                    a = c;
+                    u = dc;
+                }
+            }
+        }
+        km->upper[i] = u;
+        if (a != km->assign[i]) {
+            movePoint(km, i, km->assign[i], a);
+            km->assign[i] = a;
+            *changed += 1;
+        }
+    }
+}
+
+// Function to combine sums and counts over all ranks and move the centroids; returns points changed
+static double updateCentroids(kmeans* km, double changed, double evaluations, double* all_evaluations) {
+    int k = km->cfg.k, dims = km->cfg.dims;
+    size_t sums_len = (size_t)k * dims;
+    km->local[sums_len + k] = changed;
+    km->local[sums_len + k + 1] = evaluations;
+    MPI_Allreduce(km->local, km->global, km->reduce_len, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    const double* counts = km->global + sums_len;
+    for (int c = 0; c < k; c++) {
+        float* centroid = km->centroids + (size_t)c * dims;
+        if (counts[c] == 0) {
+            km->shift[c] = 0.0f;    // empty cluster keeps its centroid
+            continue;
+        }
+        float moved = 0.0f;
+        for (int d = 0; d < dims; d++) {
+            float v = (float)(km->global[(size_t)c * dims + d] / counts[c]);
+            float diff = v - centroid[d];
+            moved += diff * diff;
+            centroid[d] = v;
+        }
+        km->shift[c] = sqrtf(moved);
+    }
+    centroidGaps(km);
+    *all_evaluations = km->global[sums_len + k + 1];
+    return km->global[sums_len + k];
+}
+
+static void createKmeans(kmeans* km, const kmeans_config* cfg) {
+    memset(km, 0, sizeof(*km));
+    km->cfg = *cfg;
+    MPI_Comm_rank(MPI_COMM_WORLD, &km->rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &km->size);
+    blockRange(cfg->n, km->size, km->rank, &km->first, &km->count);
+    int k = cfg->k, dims = cfg->dims;
+    size_t n = km->count > 0 ? (size_t)km->count : 1;
+    size_t lower_len = cfg->algorithm == ALG_ELKAN ? n * k : n;
+    km->reduce_len = k * dims + k + 2;
+
+    km->x = (float*)malloc(sizeof(float) * n * dims);
+    km->assign = (int*)malloc(sizeof(int) * n);
+    km->scratch = (int*)malloc(sizeof(int) * n);
+    km->upper = (float*)malloc(sizeof(float) * n);
+    km->lower = (float*)malloc(sizeof(float) * lower_len);
+    km->centroids = (float*)malloc(sizeof(float) * k * dims);
+    km->ct = (float*)malloc(sizeof(float) * k * dims);
+    km->shift = (float*)calloc(k, sizeof(float));
+    km->half_gap = (float*)malloc(sizeof(float) * k);
+    km->cc = (float*)malloc(sizeof(float) * k * k);
+    km->point = (float*)malloc(sizeof(float) * dims);
+    km->dist = (float*)malloc(sizeof(float) * k);
+    km->local = (double*)calloc(km->reduce_len, sizeof(double));
+    km->global = (double*)malloc(sizeof(double) * km->reduce_len);
+    if (km->x == NULL || km->assign == NULL || km->scratch == NULL || km->upper == NULL || km->lower == NULL ||
+        km->centroids == NULL || km->ct == NULL || km->shift == NULL || km->half_gap == NULL || km->cc == NULL ||
+        km->point == NULL || km->dist == NULL || km->local == NULL || km->global == NULL) {
+        fprintf(stderr, "Process %d: failed to allocate %d points\n", km->rank, km->count);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    // Blob centers, then the local points and the initial centroids, all from the same seed
+    float* centers = (float*)malloc(sizeof(float) * cfg->blobs * dims);
+    for (int b = 0; b < cfg->blobs; b++) {
+        for (int d = 0; d < dims; d++) {
+            uint32_t r[4];
+            randomWords(cfg->seed, (uint64_t)b, (uint32_t)d, 3, r);
+            centers[(size_t)b * dims + d] = (float)(CENTER_RANGE * (2.0 * philoxUniform(r[0], r[1]) - 1.0));
+        }
+    }
+    for (int i = 0; i < km->count; i++) {
+        generatePoint(cfg, centers, km->first + i, km->point);
+        for (int d = 0; d < dims; d++)
+            km->x[(size_t)d * km->count + i] = km->point[d];
+    }
+    for (int c = 0; c < k; c++)
+        generatePoint(cfg, centers, (long long)((double)c * cfg->n / k), km->centroids + (size_t)c * dims);
+    free(centers);
+    centroidGaps(km);
+}
+
+static void destroyKmeans(kmeans* km) {
+    free(km->x);
+    free(km->assign);
+    free(km->scratch);
+    free(km->upper);
+    free(km->lower);
+    free(km->centroids);
+    free(km->ct);
+    free(km->shift);
+    free(km->half_gap);
+    free(km->cc);
+    free(km->point);
+    free(km->dist);
+    free(km->local);
+    free(km->global);
+}
+
+// Function to iterate until no point changes cluster or the iteration limit
+static kmeans_result runKmeans(kmeans* km) {
+    kmeans_result res;
+    memset(&res, 0, sizeof(res));
+    double lloyd_evaluations = (double)km->cfg.n * km->cfg.k;
+    if (km->rank == 0 && !km->cfg.quiet)
+        printf("%9s %12s %16s %10s\n", "iteration", "changed", "distances", "of lloyd");
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start = MPI_Wtime();
+    for (int it = 1; it <= km->cfg.iterations; it++) {
+        double changed = 0, evaluations = 0, all_evaluations;
+        if (it == 1) {
+            evaluations = assignAll(km);
+            changed = km->count;
+        } else if (km->cfg.algorithm == ALG_HAMERLY) {
+            hamerlyStep(km, &changed, &evaluations);
+        } else if (km->cfg.algorithm == ALG_ELKAN) {
+            elkanStep(km, &changed, &evaluations);
+        } else {
+            lloydStep(km, &changed, &evaluations);
+        }
+        double all_changed = updateCentroids(km, changed, evaluations, &all_evaluations);
+        res.iterations = it;
+        res.distances += all_evaluations;
+        if (km->rank == 0 && !km->cfg.quiet)
+            printf("%9d %12.0f %16.0f %9.1f%%\n", it, all_changed, all_evaluations,
+                   100.0 * all_evaluations / lloyd_evaluations);
+        if (all_changed == 0)
+            break;
+    }
+    double elapsed = MPI_Wtime() - start;
+    MPI_Allreduce(&elapsed, &res.time, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+    double sse = 0;
+    for (int i = 0; i < km->count; i++) {
+        double d = kmeansDistance(km->cfg.dims, km->count, km->x, i,
+                                  km->centroids + (size_t)km->assign[i] * km->cfg.dims);
+        sse += d * d;
+    }
+    MPI_Allreduce(&sse, &res.sse, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    return res;
+}
+
+static void clusterOnce(const kmeans_config* cfg, int rank, int size) {
+    kmeans km;
+    createKmeans(&km, cfg);
+    if (rank == 0)
+        printf("K-Means (%s): %lld points, %d dims, k = %d, %d blobs, %d processes\n", algorithmName(cfg->algorithm),
+               cfg->n, cfg->dims, cfg->k, cfg->blobs, size);
+    kmeans_result res = runKmeans(&km);
+    if (rank == 0) {
+        printf("%d iterations in %.3f s, %.1f Mpoints/s per iteration, SSE %.6e\n", res.iterations, res.time,
+               (double)cfg->n * res.iterations / res.time / 1e6, res.sse);
+        printf("Distance evaluations: %.0f, %.1f%% of Lloyd's %.0f\n", res.distances,
+               100.0 * res.distances / ((double)cfg->n * cfg->k * res.iterations),
+               (double)cfg->n * cfg->k * res.iterations);
+    }
+    destroyKmeans(&km);
+}
+
+// Function to time all algorithms over a sweep of k and dimensions
+static void benchmark(const kmeans_config* base, int rank, int size) {
+    const int ks[] = { 8, 32, 128 };
+    const int dims[] = { 2, 16, 64 };
+    const algorithm_t algorithms[] = { ALG_LLOYD, ALG_HAMERLY, ALG_ELKAN };
+    if (rank == 0) {
+        printf("K-Means benchmark: %lld points, up to %d iterations, %d processes\n", base->n, base->iterations,
+               size);
+        printf("%5s %5s %-8s %6s %10s %16s %10s %14s\n", "k", "dims", "method", "iters", "time s",
+               "Mpoints/s/iter", "of lloyd", "SSE");
+    }
+    for (int ki = 0; ki < 3; ki++) {
+        for (int di = 0; di < 3; di++) {
+            for (int a = 0; a < 3; a++) {
+                kmeans_config cfg = *base;
+                cfg.k = ks[ki];
+                cfg.dims = dims[di];
+                cfg.blobs = ks[ki];
+                cfg.algorithm = algorithms[a];
+                cfg.quiet = 1;
+                if (cfg.k > cfg.n)
+                    continue;
+                kmeans km;
+                createKmeans(&km, &cfg);
+                kmeans_result res = runKmeans(&km);
+                if (rank == 0)
+                    printf("%5d %5d %-8s %6d %10.3f %16.2f %9.1f%% %14.6e\n", cfg.k, cfg.dims,
+                           algorithmName(cfg.algorithm), res.iterations, res.time,
+                           (double)cfg.n * res.iterations / res.time / 1e6,
+                           100.0 * res.distances / ((double)cfg.n * cfg.k * res.iterations), res.sse);
+                destroyKmeans(&km);
+            }
+        }
+    }
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [options]\n", prog);
+    fprintf(stderr, "  -n points               points in total (e.g. 1e7), default %d\n", DEFAULT_POINTS);
+    fprintf(stderr, "  -d dims                 dimensions, default %d\n", DEFAULT_DIMS);
+    fprintf(stderr, "  -k clusters             centroids, default %d\n", DEFAULT_K);
+    fprintf(stderr, "  -b blobs                Gaussian clusters in the data, default k\n");
+    fprintf(stderr, "  -a lloyd|hamerly|elkan  assignment method, default hamerly\n");
+    fprintf(stderr, "  -i iterations           iteration limit, default %d\n", DEFAULT_ITERATIONS);
+    fprintf(stderr, "  -s seed                 data seed (Philox key), default %d\n", DEFAULT_SEED);
+    fprintf(stderr, "  -q                      no per-iteration output\n");
+    fprintf(stderr, "  -B                      benchmark every method for k = 8, 32, 128 and 2, 16, 64 dims\n");
+}
+
+int main(int argc, char* argv[]) {
+    int rank, size;
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    kmeans_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.n = DEFAULT_POINTS;
+    cfg.dims = DEFAULT_DIMS;
+    cfg.k = DEFAULT_K;
+    cfg.algorithm = ALG_HAMERLY;
+    cfg.iterations = DEFAULT_ITERATIONS;
+    cfg.seed = DEFAULT_SEED;
+    int bench = 0, bad = 0;
+
+    // Parse command line options (every rank parses the same argv)
+    int opt;
+    while ((opt = getopt(argc, argv, "n:d:k:b:a:i:s:qB")) != -1) {
+        switch (opt) {
+        case 'n': cfg.n = (long long)strtod(optarg, NULL); break;
+        case 'd': cfg.dims = atoi(optarg); break;
+        case 'k': cfg.k = atoi(optarg); break;
+        case 'b': cfg.blobs = atoi(optarg); break;
+        case 'a':
+            if (strcmp(optarg, "lloyd") == 0) cfg.algorithm = ALG_LLOYD;
+            else if (strcmp(optarg, "hamerly") == 0) cfg.algorithm = ALG_HAMERLY;
+            else if (strcmp(optarg, "elkan") == 0) cfg.algorithm = ALG_ELKAN;
+            else bad = 1;
+            break;
+        case 'i': cfg.iterations = atoi(optarg); break;
+        case 's': cfg.seed = strtoull(optarg, NULL, 10); break;
+        case 'q': cfg.quiet = 1; break;
+        case 'B': bench = 1; break;
+        default: bad = 1;
+        }
+    }
+    if (cfg.blobs == 0)
+        cfg.blobs = cfg.k;
+    if (bad || cfg.dims < 1 || cfg.k < 1 || cfg.blobs < 1 || cfg.iterations < 1 || cfg.n < cfg.k ||
+        cfg.n / size > 2147483647LL) {
+        if (rank == 0) usage(argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+
+    if (bench)
+        benchmark(&cfg, rank, size);
+    else
+        clusterOnce(&cfg, rank, size);
+
+    MPI_Finalize();
+    return 0;
+}
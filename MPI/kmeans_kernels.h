@@ -0,0 +1,104 @@
+// kmeans_kernels.h
+// Distance kernels of kmeans.c: points in SoA layout, x[d * stride + i] is coordinate d of point i
+#ifndef KMEANS_KERNELS_H
+#define KMEANS_KERNELS_H
+
+#include <math.h>
+
+#ifdef USE_ISPC
+#include "kmeans_ispc.h"
+#endif
+
+/*
+    kmeansNearest() is the Lloyd assignment: for every point, the nearest and
+    second nearest centroid (centroids stored k x dims). The C loop walks a
+    tile of KMEANS_TILE points at a time with the point index innermost, so
+    each coordinate row of the tile is one unit-stride vector; the ISPC version
+    gives every program instance one point.
+
+    kmeansDistances() gives the distances of one point to all k centroids,
+    with the centroids transposed (ct[d * k + c]) so the loop runs over
+    centroids. kmeansDistance() is the scalar distance to one centroid that
+    the bounds of Hamerly and Elkan fall back to.
+
+    All three add the squared differences in dimension order and return the
+    Euclidean distance, so a distance does not depend on which kernel
+    computed it (build with -ffp-contract=off / --opt=disable-fma to keep it
+    that way).
+*/
+
+#define KMEANS_TILE 64
+
+// Function to find the nearest and second nearest centroid of count points
+static void kmeansNearest(int count, int dims, int stride, const float* x, int k, const float* centroids,
+                          int* assign, float* best, float* second) {
+#ifdef USE_ISPC
+    kmeans_nearest(count, dims, stride, (float*)x, k, (float*)centroids, assign, best, second);
+#else
+    float dist[KMEANS_TILE];
+    for (int t = 0; t < count; t += KMEANS_TILE) {
+        int len = count - t < KMEANS_TILE ? count - t : KMEANS_TILE;
+        for (int i = 0; i < len; i++) {
+            best[t + i] = INFINITY;
+            second[t + i] = INFINITY;
+            assign[t + i] = 0;
+        }
+        for (int c = 0; c < k; c++) {
+            for (int i = 0; i < len; i++)
+                dist[i] = 0.0f;
+            for (int d = 0; d < dims; d++) {
+                const float* xd = x + (size_t)d * stride + t;
+                float cd = centroids[(size_t)c * dims + d];
+                for (int i = 0; i < len; i++) {
+                    float diff = xd[i] - cd;
+                    dist[i] += diff * diff;
+                }
+            }
+            for (int i = 0; i < len; i++) {
+                if (dist[i] < best[t + i]) {
+                    second[t + i] = best[t + i];
+                    best[t + i] = dist[i];
+                    assign[t + i] = c;
+                } else if (dist[i] < second[t + i]) {
+                    second[t + i] = dist[i];
+                }
+            }
+        }
+        for (int i = 0; i < len; i++) {
+            best[t + i] = sqrtf(best[t + i]);
+            second[t + i] = sqrtf(second[t + i]);
+        }
+    }
+#endif
+}
+
+// Function to get the distances of one point to all k centroids (ct is dims x k)
+static void kmeansDistances(int dims, int k, const float* ct, const float* point, float* out) {
+#ifdef USE_ISPC
+    kmeans_distances(dims, k, (float*)ct, (float*)point, out);
+#else
+    for (int c = 0; c < k; c++)
+        out[c] = 0.0f;
+    for (int d = 0; d < dims; d++) {
+        const float* row = ct + (size_t)d * k;
+        for (int c = 0; c < k; c++) {
+            float diff = point[d] - row[c];
+            out[c] += diff * diff;
+        }
+    }
+    for (int c = 0; c < k; c++)
+        out[c] = sqrtf(out[c]);
+#endif
+}
+
+// Function to get the distance of point i to one centroid
+static inline float kmeansDistance(int dims, int stride, const float* x, int i, const float* centroid) {
+    float dist = 0.0f;
+    for (int d = 0; d < dims; d++) {
+        float diff = x[(size_t)d * stride + i] - centroid[d];
+        dist += diff * diff;
+    }
+    return sqrtf(dist);
+}
+
+#endif
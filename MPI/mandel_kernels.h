@@ -0,0 +1,186 @@
+// mandel_kernels.h
+// Pixel and row kernels shared by mandelbrot.c, mandelbrot_bench.c and mandelbrot_zoom.c
+#ifndef MANDEL_KERNELS_H
+#define MANDEL_KERNELS_H
+
+#include <stddef.h>
+
+#ifdef USE_ISPC
+#include "mandelbrot_ispc.h"
+#ifdef __cplusplus
+// the generated header puts the kernel in namespace ispc when compiled as C++
+using ispc::mandel_ispc_row;
+#endif
+#endif
+
+// Band of consecutive rows handed to the rectangle-filling kernel at once
+#define FILL_BAND_ROWS 32
+// Rectangles smaller than this are computed pixel by pixel
+#define FILL_MIN_SIZE 8
+
+/*
+    A rows kernel computes num_rows consecutive image rows starting at first_row
+    and stores them back to back in output. Pixel (i, row) sits at
+    (x0 + i * dx, y0 + row * dy), exactly as in mandelbrotSerial().
+*/
+typedef void (*rows_kernel)(float x0, float y0, float dx, float dy, int first_row, int num_rows,
+                            int width, int maxIterations, int* output);
+
+// Function to compute a single pixel's value
+static inline int mandel(float c_re, float c_im, int max_iterations) {
+    float z_re = c_re, z_im = c_im;
+    int i;
+    for (i = 0; i < max_iterations; ++i) {
+        if (z_re * z_re + z_im * z_im > 4.0f)
+            break;
+
+        float new_re = z_re * z_re - z_im * z_im;
+        float new_im = 2.0f * z_re * z_im;
+        z_re = c_re + new_re;
+        z_im = c_im + new_im;
+    }
+    return i;
+}
+
+/*
+    Same result as mandel(), but interior points stop early:
+    - points strictly inside the main cardioid or the period-2 bulb never escape,
+      so they are answered analytically without iterating;
+    - other orbits are compared against a snapshot refreshed at power-of-two
+      steps (Brent). In float arithmetic the orbit is deterministic, so once z
+      repeats exactly it cycles through values that already passed the escape
+      test and can never escape; the answer is max_iterations.
+*/
+static inline int mandelFast(float c_re, float c_im, int max_iterations) {
+    double x = c_re, y = c_im;
+    double y2 = y * y;
+    double q = (x - 0.25) * (x - 0.25) + y2;
+    if (q * (q + (x - 0.25)) < 0.25 * y2)
+        return max_iterations;
+    if ((x + 1.0) * (x + 1.0) + y2 < 0.0625)
+        return max_iterations;
+
+    float z_re = c_re, z_im = c_im;
+    float saved_re = z_re, saved_im = z_im;
+    int next_snapshot = 8;
+    int i;
+    for (i = 0; i < max_iterations; ++i) {
+        if (z_re * z_re + z_im * z_im > 4.0f)
+            break;
+
+        float new_re = z_re * z_re - z_im * z_im;
+        float new_im = 2.0f * z_re * z_im;
+        z_re = c_re + new_re;
+        z_im = c_im + new_im;
+
+        if (z_re == saved_re && z_im == saved_im)
+            return max_iterations;
+        if (i + 1 == next_snapshot) {
+            saved_re = z_re;
+            saved_im = z_im;
+            next_snapshot *= 2;
+        }
+    }
+    return i;
+}
+
+// Function to compute consecutive rows with the scalar kernel
+static inline void mandelRows(float x0, float y0, float dx, float dy, int first_row, int num_rows,
+                              int width, int maxIterations, int* output) {
+    for (int j = 0; j < num_rows; j++) {
+        float y = y0 + (first_row + j) * dy;
+        for (int i = 0; i < width; i++) {
+            float x = x0 + i * dx;
+            output[(size_t)j * width + i] = mandel(x, y, maxIterations);
+        }
+    }
+}
+
+// Function to compute consecutive rows with the cardioid/bulb/cycle fast path
+static inline void mandelRowsFast(float x0, float y0, float dx, float dy, int first_row, int num_rows,
+                                  int width, int maxIterations, int* output) {
+    for (int j = 0; j < num_rows; j++) {
+        float y = y0 + (first_row + j) * dy;
+        for (int i = 0; i < width; i++) {
+            float x = x0 + i * dx;
+            output[(size_t)j * width + i] = mandelFast(x, y, maxIterations);
+        }
+    }
+}
+
+#ifdef USE_ISPC
+// Same rows contract, evaluated a gang of pixels at a time
+static inline void mandelRowsISPC(float x0, float y0, float dx, float dy, int first_row, int num_rows,
+                                  int width, int maxIterations, int* output) {
+    for (int j = 0; j < num_rows; j++)
+        mandel_ispc_row(x0, y0, dx, dy, first_row + j, width, maxIterations, output + (size_t)j * width);
+}
+#endif
+
+// State shared by the recursive rectangle filler for one band of rows
+typedef struct {
+    float x0, y0, dx, dy;
+    int first_row, width, maxIterations;
+    int* output;    // band buffer, -1 marks pixels not computed yet
+} fill_band;
+
+static inline int fillPixel(fill_band* band, int i, int j) {
+    int* p = band->output + (size_t)j * band->width + i;
+    if (*p < 0)
+        *p = mandelFast(band->x0 + i * band->dx, band->y0 + (band->first_row + j) * band->dy,
+                        band->maxIterations);
+    return *p;
+}
+
+/*
+    Mariani-Silver rectangle filling. The Mandelbrot set is connected and has no
+    holes, so a rectangle whose border lies in the set is filled with
+    max_iterations without iterating its interior. Otherwise the rectangle is
+    split in two along its longer side; the shared edge is computed only once.
+    The border is only sampled at pixel centres, so a filament thinner than a
+    pixel can be missed: unlike mandelFast() this is not guaranteed to match
+    mandelbrotSerial() exactly.
+*/
+static inline void fillRect(fill_band* band, int i0, int j0, int w, int h) {
+    if (w < FILL_MIN_SIZE || h < FILL_MIN_SIZE) {
+        for (int j = j0; j < j0 + h; j++)
+            for (int i = i0; i < i0 + w; i++)
+                fillPixel(band, i, j);
+        return;
+    }
+
+    int inside = 1;
+    for (int i = i0; i < i0 + w; i++) {
+        inside &= fillPixel(band, i, j0) == band->maxIterations;
+        inside &= fillPixel(band, i, j0 + h - 1) == band->maxIterations;
+    }
+    for (int j = j0 + 1; j < j0 + h - 1; j++) {
+        inside &= fillPixel(band, i0, j) == band->maxIterations;
+        inside &= fillPixel(band, i0 + w - 1, j) == band->maxIterations;
+    }
+
+    if (inside) {
+        for (int j = j0 + 1; j < j0 + h - 1; j++)
+            for (int i = i0 + 1; i < i0 + w - 1; i++)
+                band->output[(size_t)j * band->width + i] = band->maxIterations;
+    } else if (w >= h) {
+        int half = w / 2;
+        fillRect(band, i0, j0, half + 1, h);
+        fillRect(band, i0 + half, j0, w - half, h);
+    } else {
+        int half = h / 2;
+        fillRect(band, i0, j0, w, half + 1);
+        fillRect(band, i0, j0 + half, w, h - half);
+    }
+}
+
+// Function to compute consecutive rows with rectangle filling on top of the fast path
+static inline void mandelRowsFill(float x0, float y0, float dx, float dy, int first_row, int num_rows,
+                                  int width, int maxIterations, int* output) {
+    fill_band band = { x0, y0, dx, dy, first_row, width, maxIterations, output };
+    for (size_t p = 0; p < (size_t)num_rows * width; p++)
+        output[p] = -1;
+    fillRect(&band, 0, 0, width, num_rows);
+}
+
+#endif
@@ -3,25 +3,178 @@
 #include <mpi.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "mandel_kernels.h"
+#include "ppm_image.h"
 
 #define WIDTH 12800  
 #define HEIGHT 9600  
 #define MAX_ITERATIONS 1024 
+#define DEFAULT_TILE_ROWS 8
+
+// Row scheduling modes selectable with -s
+typedef enum {
+    SCHED_STATIC,   // contiguous row blocks (original decomposition)
+    SCHED_CYCLIC,   // interleaved rows: row j belongs to rank j % size
+    SCHED_DYNAMIC   // tiles of rows handed out by a shared atomic counter
+} schedule_t;
+
+// Pixel kernels selectable with -k
+typedef enum {
+    KERNEL_SCALAR,  // mandel(), one pixel at a time
+    KERNEL_ISPC,    // mandelbrot.ispc, one gang of pixels at a time
+    KERNEL_FAST,    // mandelFast(): cardioid/bulb test and cycle detection, exact
+    KERNEL_FILL     // mandelFast() plus rectangle filling, not guaranteed exact
+} kernel_t;
+
+// Per-rank timing statistics reported at the end of the run
+typedef struct {
+    double busy;    // time spent inside the compute kernel
+    double sched;   // time spent asking for work (dynamic mode only)
+    double idle;    // time spent waiting for the slowest rank to finish
+    double rows;    // number of rows computed by this rank
+} rank_stats;
+
+/*
+    Intra-rank thread pool.
+    The threads are created once and then sleep on a condition variable between
+    jobs, so the dynamic schedule can hand them one tile after another without
+    paying thread creation each time. Inside a job, threads claim bands of up to
+    `band` consecutive rows (one row for the per-pixel kernels) so threads that
+    hit the set's interior don't hold the others back.
+    Only the calling (main) thread ever talks to MPI.
+*/
+typedef struct {
+    pthread_t* threads;
+    int num_threads;            // helper threads, the caller works too
+    pthread_mutex_t lock;
+    pthread_cond_t job_ready;
+    pthread_cond_t job_done;
+    unsigned generation;        // bumped for every new job
+    int shutdown;
+    int working;                // helpers still busy with the current job
+
+    rows_kernel kernel;
+    int band;                   // max consecutive rows claimed at once
+
+    // current job
+    float x0, y0, dx, dy;
+    int width, maxIterations;
+    const int* rows;
+    int num_rows;
+    int next_row;
+    int* output;
+} row_pool;
+
+// Function to count how many rows starting at rows[j] are consecutive image rows (at most band)
+static int consecutiveRows(const int* rows, int j, int num_rows, int band) {
+    int n = 1;
+    while (n < band && j + n < num_rows && rows[j + n] == rows[j] + n)
+        n++;
+    return n;
+}
 
-// Function to compute a single pixel's value
-static inline int mandel(float c_re, float c_im, int max_iterations) {
-    float z_re = c_re, z_im = c_im;
-    int i;
-    for (i = 0; i < max_iterations; ++i) {
-        if (z_re * z_re + z_im * z_im > 4.0f)
+// Function to claim and compute bands of the current job until none are left
+static void poolWork(row_pool* pool) {
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        int j = pool->next_row;
+        int n = j < pool->num_rows ? consecutiveRows(pool->rows, j, pool->num_rows, pool->band) : 0;
+        pool->next_row += n;
+        pthread_mutex_unlock(&pool->lock);
+        if (n == 0)
             break;
+        pool->kernel(pool->x0, pool->y0, pool->dx, pool->dy, pool->rows[j], n,
+                     pool->width, pool->maxIterations, pool->output + (size_t)j * pool->width);
+    }
+}
+
+static void* poolThread(void* arg) {
+    row_pool* pool = (row_pool*)arg;
+    unsigned seen = 0;
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->generation == seen && !pool->shutdown)
+            pthread_cond_wait(&pool->job_ready, &pool->lock);
+        if (pool->shutdown) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        poolWork(pool);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->working == 0)
+            pthread_cond_signal(&pool->job_done);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+static int poolInit(row_pool* pool, int num_threads, rows_kernel kernel, int band) {
+    memset(pool, 0, sizeof(*pool));
+    pool->kernel = kernel;
+    pool->band = band;
+    pool->num_threads = num_threads > 1 ? num_threads - 1 : 0;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->job_ready, NULL);
+    pthread_cond_init(&pool->job_done, NULL);
+    pool->threads = (pthread_t*)malloc((pool->num_threads + 1) * sizeof(pthread_t));
+    if (pool->threads == NULL)
+        return 0;
+    for (int t = 0; t < pool->num_threads; t++) {
+        if (pthread_create(&pool->threads[t], NULL, poolThread, pool) != 0)
+            return 0;
+    }
+    return 1;
+}
+
+static void poolDestroy(row_pool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->job_ready);
+    pthread_mutex_unlock(&pool->lock);
+    for (int t = 0; t < pool->num_threads; t++)
+        pthread_join(pool->threads[t], NULL);
+    free(pool->threads);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->job_ready);
+    pthread_cond_destroy(&pool->job_done);
+}
 
-        float new_re = z_re * z_re - z_im * z_im;
-        float new_im = 2.0f * z_re * z_im;
-        z_re = c_re + new_re;
-        z_im = c_im + new_im;
+// Function to compute a list of rows with all threads of the pool; rows land back to back in output
+static void poolComputeRows(row_pool* pool, float x0, float y0, float dx, float dy,
+                            int width, int maxIterations, const int* rows, int num_rows, int* output) {
+    if (pool->num_threads == 0) {
+        for (int j = 0, n; j < num_rows; j += n) {
+            n = consecutiveRows(rows, j, num_rows, pool->band);
+            pool->kernel(x0, y0, dx, dy, rows[j], n, width, maxIterations, output + (size_t)j * width);
+        }
+        return;
     }
-    return i;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->x0 = x0; pool->y0 = y0; pool->dx = dx; pool->dy = dy;
+    pool->width = width;
+    pool->maxIterations = maxIterations;
+    pool->rows = rows;
+    pool->num_rows = num_rows;
+    pool->next_row = 0;
+    pool->output = output;
+    pool->working = pool->num_threads;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->job_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    poolWork(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->working > 0)
+        pthread_cond_wait(&pool->job_done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
 }
 
 // Serial implementation of Mandelbrot calculation
@@ -44,45 +197,24 @@ double mandelbrotSerial(float x0, float y0, float x1, float y1,
     return end_time - start_time;
 }
 
-// Function to write the PPM image
-void writePPMImage(int* data, int width, int height, const char* filename, int maxIterations) {
-    FILE* fp = fopen(filename, "wb");
-    if (!fp) {
-        fprintf(stderr, "Error: Unable to open output file '%s'\n", filename);
-        return;
-    }
-
-    // Write PPM header
-    fprintf(fp, "P6\n%d %d\n255\n", width, height);
+// Serial reference for a list of rows, used to verify each rank's rows in place
+void mandelbrotSerialRows(float x0, float y0, float x1, float y1, int width, int height,
+                            int maxIterations, const int* rows, int num_rows, int* output) {
+    float dx = (x1 - x0) / width;
+    float dy = (y1 - y0) / height;
 
-    // Write image data
-    for (int j = 0; j < height; j++) {
+    for (int j = 0; j < num_rows; j++) {
         for (int i = 0; i < width; i++) {
-            int value = data[j * width + i];
-            
-            // Convert iteration count to color (simple mapping)
-            unsigned char r, g, b;
-            if (value == maxIterations) {
-                r = g = b = 0;  // Black for points in the set
-            } else {
-                // Color gradient based on iteration count
-                value = value % 16;
-                r = (value * 16) % 256;
-                g = (value * 8) % 256;
-                b = (value * 32) % 256;
-            }
-            
-            fputc(r, fp);
-            fputc(g, fp);
-            fputc(b, fp);
+            float x = x0 + i * dx;
+            float y = y0 + rows[j] * dy;
+            output[(size_t)j * width + i] = mandel(x, y, maxIterations);
         }
     }
-    fclose(fp);
 }
 
 // Function to verify results between serial and parallel implementations
 int verifyResults(int* serial, int* parallel, int width, int height) {
-    for (int i = 0; i < width * height; i++) {
+    for (size_t i = 0; i < (size_t)width * height; i++) {
         if (serial[i] != parallel[i]) {
             return 0;
         }
@@ -90,115 +222,315 @@ int verifyResults(int* serial, int* parallel, int width, int height) {
     return 1; 
 }
 
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-s static|cyclic|dynamic] [-g tile_rows] [-k scalar|ispc|fast|fill] [-t threads] [-S]\n", prog);
+    fprintf(stderr, "  -k fast skips interior points exactly, -k fill also fills uniform interior rectangles\n");
+    fprintf(stderr, "  -t 0 uses every online core of the node for each rank\n");
+    fprintf(stderr, "  -S   time a full serial run on rank 0 for the speedup and write mandelbrot_serial.ppm\n");
+}
+
+// Function to append a row slot to the growable local buffers used by the dynamic schedule
+static int* reserveRows(int** rows, int** output, int* capacity, int needed, int width) {
+    if (needed > *capacity) {
+        int new_capacity = *capacity ? *capacity : 64;
+        while (new_capacity < needed)
+            new_capacity *= 2;
+        *rows = (int*)realloc(*rows, new_capacity * sizeof(int));
+        *output = (int*)realloc(*output, (size_t)new_capacity * width * sizeof(int));
+        if (*rows == NULL || *output == NULL)
+            return NULL;
+        *capacity = new_capacity;
+    }
+    return *output;
+}
+
 int main(int argc, char** argv) {
     int rank, size;
     double start_time, end_time;
     float x0 = -2.0f, y0 = -1.0f;
     float x1 = 1.0f, y1 = 1.0f;
+    schedule_t schedule = SCHED_STATIC;
+    int tile_rows = DEFAULT_TILE_ROWS;
+    kernel_t kernel_mode = KERNEL_SCALAR;
+    int num_threads = 1;
+    int run_serial = 0;
+    int provided;
     
-    // Initialize MPI
-    MPI_Init(&argc, &argv);
+    // Initialize MPI; worker threads never call MPI, only the main thread does
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
-    
-    // Calculate workload distribution - each process gets a set of rows
-    int rows_per_process = HEIGHT / size;
-    int remainder = HEIGHT % size;
-    
-    // Process 0 might get a slightly larger chunk if HEIGHT is not divisible by size
-    int my_start_row = rank * rows_per_process + (rank < remainder ? rank : remainder);
-    int my_num_rows = rows_per_process + (rank < remainder ? 1 : 0);
-    int my_end_row = my_start_row + my_num_rows;
-    
+
+    // Parse command line options (every rank parses the same argv)
+    int opt;
+    while ((opt = getopt(argc, argv, "s:g:k:t:S")) != -1) {
+        switch (opt) {
+        case 's':
+            if (strcmp(optarg, "static") == 0) schedule = SCHED_STATIC;
+            else if (strcmp(optarg, "cyclic") == 0) schedule = SCHED_CYCLIC;
+            else if (strcmp(optarg, "dynamic") == 0) schedule = SCHED_DYNAMIC;
+            else {
+                if (rank == 0) usage(argv[0]);
+                MPI_Finalize();
+                return 1;
+            }
+            break;
+        case 'g':
+            tile_rows = atoi(optarg);
+            break;
+        case 'k':
+            if (strcmp(optarg, "scalar") == 0) kernel_mode = KERNEL_SCALAR;
+            else if (strcmp(optarg, "ispc") == 0) kernel_mode = KERNEL_ISPC;
+            else if (strcmp(optarg, "fast") == 0) kernel_mode = KERNEL_FAST;
+            else if (strcmp(optarg, "fill") == 0) kernel_mode = KERNEL_FILL;
+            else {
+                if (rank == 0) usage(argv[0]);
+                MPI_Finalize();
+                return 1;
+            }
+            break;
+        case 't':
+            num_threads = atoi(optarg);
+            break;
+        case 'S':
+            run_serial = 1;
+            break;
+        default:
+            if (rank == 0) usage(argv[0]);
+            MPI_Finalize();
+            return 1;
+        }
+    }
+    if (tile_rows < 1)
+        tile_rows = 1;
+    if (num_threads < 1)
+        num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (provided < MPI_THREAD_FUNNELED && num_threads > 1 && rank == 0)
+        fprintf(stderr, "Warning: MPI library does not provide MPI_THREAD_FUNNELED\n");
+
+    rows_kernel kernel = mandelRows;
+    int band = 1;
+    if (kernel_mode == KERNEL_ISPC) {
+#ifdef USE_ISPC
+        kernel = mandelRowsISPC;
+#else
+        if (rank == 0)
+            fprintf(stderr, "Error: built without ISPC support (compile with -DUSE_ISPC and link mandelbrot_ispc.o)\n");
+        MPI_Finalize();
+        return 1;
+#endif
+    } else if (kernel_mode == KERNEL_FAST) {
+        kernel = mandelRowsFast;
+    } else if (kernel_mode == KERNEL_FILL) {
+        // Filling needs rectangles, so threads take bands of consecutive rows
+        kernel = mandelRowsFill;
+        band = FILL_BAND_ROWS;
+    }
+
+    row_pool pool;
+    if (!poolInit(&pool, num_threads, kernel, band)) {
+        fprintf(stderr, "Process %d: Thread creation failed\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    static const char* schedule_names[] = { "static", "cyclic", "dynamic" };
+    static const char* kernel_names[] = { "scalar", "ispc", "fast", "fill" };
     if (rank == 0) {
         printf("Mandelbrot calculation with %d MPI processes\n", size);
         printf("Image size: %d x %d, Max iterations: %d\n", WIDTH, HEIGHT, MAX_ITERATIONS);
+        printf("Kernel: %s, %d thread(s) per process\n", kernel_names[kernel_mode], num_threads);
+        printf("Schedule: %s", schedule_names[schedule]);
+        if (schedule == SCHED_DYNAMIC)
+            printf(" (%d rows per tile)", tile_rows);
+        printf("\n");
     }
-    
+
+    // Every schedule produces a list of the rows this rank computed (in increasing
+    // order) and a buffer holding those rows back to back
+    int* my_rows = NULL;
+    int* local_output = NULL;
+    int my_num_rows = 0;
+    int capacity = 0;
+
+    if (schedule == SCHED_STATIC) {
+        // Calculate workload distribution - each process gets a set of rows
+        int rows_per_process = HEIGHT / size;
+        int remainder = HEIGHT % size;
+
+        // Process 0 might get a slightly larger chunk if HEIGHT is not divisible by size
+        int my_start_row = rank * rows_per_process + (rank < remainder ? rank : remainder);
+        my_num_rows = rows_per_process + (rank < remainder ? 1 : 0);
+        capacity = my_num_rows;
+        my_rows = (int*)malloc((my_num_rows + 1) * sizeof(int));
+        for (int j = 0; j < my_num_rows; j++)
+            my_rows[j] = my_start_row + j;
+    } else if (schedule == SCHED_CYCLIC) {
+        my_num_rows = HEIGHT / size + (rank < HEIGHT % size ? 1 : 0);
+        capacity = my_num_rows;
+        my_rows = (int*)malloc((my_num_rows + 1) * sizeof(int));
+        for (int j = 0; j < my_num_rows; j++)
+            my_rows[j] = rank + j * size;
+    }
+
     // Calculate values for assigned rows
-    int* local_output = (int*)malloc(my_num_rows * WIDTH * sizeof(int));
-    if (local_output == NULL) {
-        fprintf(stderr, "Process %d: Memory allocation failed\n", rank);
-        MPI_Abort(MPI_COMM_WORLD, 1);
+    if (capacity > 0) {
+        local_output = (int*)malloc((size_t)capacity * WIDTH * sizeof(int));
+        if (local_output == NULL || my_rows == NULL) {
+            fprintf(stderr, "Process %d: Memory allocation failed\n", rank);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
     }
-    
-    // Start timing for parallel implementation
-    start_time = MPI_Wtime();
-    
+
+    // Shared tile counter living on rank 0 for the dynamic schedule
+    MPI_Win counter_win = MPI_WIN_NULL;
+    int* counter = NULL;
+    if (schedule == SCHED_DYNAMIC) {
+        MPI_Win_allocate(rank == 0 ? sizeof(int) : 0, sizeof(int), MPI_INFO_NULL,
+                         MPI_COMM_WORLD, &counter, &counter_win);
+        if (rank == 0) {
+            MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, counter_win);
+            *counter = 0;
+            MPI_Win_unlock(0, counter_win);
+        }
+    }
+
     // Calculate parameters
     float dx = (x1 - x0) / WIDTH;
     float dy = (y1 - y0) / HEIGHT;
-    
-    // Compute Mandelbrot set for this process's portion
-    for (int j = 0; j < my_num_rows; j++) {
-        for (int i = 0; i < WIDTH; i++) {
-            float x = x0 + i * dx;
-            float y = y0 + (j + my_start_row) * dy;
-            local_output[j * WIDTH + i] = mandel(x, y, MAX_ITERATIONS);
+    rank_stats stats = { 0.0, 0.0, 0.0, 0.0 };
+
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    // Start timing for parallel implementation
+    start_time = MPI_Wtime();
+
+    if (schedule == SCHED_DYNAMIC) {
+        // Self-scheduling: every rank atomically grabs the next tile until none are left,
+        // so ranks stuck in the set's interior simply take fewer tiles
+        int num_tiles = (HEIGHT + tile_rows - 1) / tile_rows;
+        const int one = 1;
+        MPI_Win_lock_all(0, counter_win);
+        for (;;) {
+            int tile;
+            double t0 = MPI_Wtime();
+            MPI_Fetch_and_op(&one, &tile, MPI_INT, 0, 0, MPI_SUM, counter_win);
+            MPI_Win_flush(0, counter_win);
+            double t1 = MPI_Wtime();
+            stats.sched += t1 - t0;
+            if (tile >= num_tiles)
+                break;
+
+            int first_row = tile * tile_rows;
+            int rows = (first_row + tile_rows <= HEIGHT) ? tile_rows : HEIGHT - first_row;
+            if (reserveRows(&my_rows, &local_output, &capacity, my_num_rows + rows, WIDTH) == NULL) {
+                fprintf(stderr, "Process %d: Memory allocation failed\n", rank);
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            for (int j = 0; j < rows; j++)
+                my_rows[my_num_rows + j] = first_row + j;
+            poolComputeRows(&pool, x0, y0, dx, dy, WIDTH, MAX_ITERATIONS,
+                            my_rows + my_num_rows, rows, local_output + (size_t)my_num_rows * WIDTH);
+            my_num_rows += rows;
+            stats.busy += MPI_Wtime() - t1;
         }
+        MPI_Win_unlock_all(counter_win);
+    } else {
+        // Compute Mandelbrot set for this process's portion
+        poolComputeRows(&pool, x0, y0, dx, dy, WIDTH, MAX_ITERATIONS,
+                        my_rows, my_num_rows, local_output);
+        stats.busy = MPI_Wtime() - start_time;
     }
-    
+
     // End timing calculation for parallel portion
     end_time = MPI_Wtime();
     double local_time = end_time - start_time;
     double max_parallel_time;
-    
+
+    // Time spent waiting here is load imbalance
+    MPI_Barrier(MPI_COMM_WORLD);
+    stats.idle = MPI_Wtime() - end_time;
+    stats.rows = my_num_rows;
+
     MPI_Reduce(&local_time, &max_parallel_time, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
-    
-    // Gather results to process 0
-    int* gather_counts = NULL;
-    int* displacements = NULL;
-    int* full_output = NULL;
-    
+
+    if (counter_win != MPI_WIN_NULL)
+        MPI_Win_free(&counter_win);
+    poolDestroy(&pool);
+
+    // Gather per-rank statistics to process 0
+    rank_stats* all_stats = NULL;
+    if (rank == 0)
+        all_stats = (rank_stats*)malloc(size * sizeof(rank_stats));
+    MPI_Gather(&stats, 4, MPI_DOUBLE, all_stats, 4, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+    // Every rank writes its own rows straight into the shared image
+    double write_start = MPI_Wtime();
+    int write_ok = writePPMImageMPI(local_output, my_rows, my_num_rows, WIDTH, HEIGHT,
+                                    "mandelbrot_mpi.ppm", MAX_ITERATIONS, MPI_COMM_WORLD);
+    double write_time = MPI_Wtime() - write_start;
+    double max_write_time;
+    MPI_Reduce(&write_time, &max_write_time, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    // Verify in place: each rank recomputes its own rows with the serial kernel. These
+    // runs overlap on all ranks (and share cores, caches and SMT siblings), so their
+    // times say nothing about a serial run and are not used for the speedup.
+    int* reference = (int*)malloc(((size_t)my_num_rows * WIDTH + 1) * sizeof(int));
+    if (reference == NULL) {
+        fprintf(stderr, "Process %d: Memory allocation failed\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    mandelbrotSerialRows(x0, y0, x1, y1, WIDTH, HEIGHT, MAX_ITERATIONS, my_rows, my_num_rows, reference);
+    int local_match = verifyResults(reference, local_output, WIDTH, my_num_rows);
+    free(reference);
+
+    int results_match;
+    MPI_Reduce(&local_match, &results_match, 1, MPI_INT, MPI_LAND, 0, MPI_COMM_WORLD);
+
     if (rank == 0) {
-        // Allocate memory for the complete output
-        full_output = (int*)malloc(WIDTH * HEIGHT * sizeof(int));
-        if (full_output == NULL) {
-            fprintf(stderr, "Master process: Memory allocation failed\n");
-            MPI_Abort(MPI_COMM_WORLD, 1);
-        }
-        
-        // Calculate counts and displacements for MPI_Gatherv
-        gather_counts = (int*)malloc(size * sizeof(int));
-        displacements = (int*)malloc(size * sizeof(int));
-        
+        // Report per-rank load balance
+        double busy_sum = 0.0, busy_max = 0.0;
+        printf("\n%6s %8s %12s %12s %12s %7s\n", "Rank", "Rows", "Busy (ms)", "Sched (ms)", "Idle (ms)", "Busy%");
         for (int i = 0; i < size; i++) {
-            int proc_rows = rows_per_process + (i < remainder ? 1 : 0);
-            gather_counts[i] = proc_rows * WIDTH;
-            displacements[i] = (i * rows_per_process + (i < remainder ? i : remainder)) * WIDTH;
+            double total = all_stats[i].busy + all_stats[i].sched + all_stats[i].idle;
+            printf("%6d %8.0f %12.3f %12.3f %12.3f %6.1f%%\n", i, all_stats[i].rows,
+                   all_stats[i].busy * 1000, all_stats[i].sched * 1000, all_stats[i].idle * 1000,
+                   total > 0.0 ? 100.0 * all_stats[i].busy / total : 0.0);
+            busy_sum += all_stats[i].busy;
+            if (all_stats[i].busy > busy_max)
+                busy_max = all_stats[i].busy;
         }
-    }
-    
-    // Gather all results to process 0
-    MPI_Gatherv(local_output, my_num_rows * WIDTH, MPI_INT,
-                full_output, gather_counts, displacements, MPI_INT,
-                0, MPI_COMM_WORLD);
-    
-    // Only process 0 runs the serial version and performs the comparison
-    if (rank == 0) {
-        // Write the parallel output
-        writePPMImage(full_output, WIDTH, HEIGHT, "mandelbrot_mpi.ppm", MAX_ITERATIONS);
-        
-        // Now run the serial implementation for comparison
-        int* serial_output = (int*)malloc(WIDTH * HEIGHT * sizeof(int));
-        if (serial_output == NULL) {
-            fprintf(stderr, "Serial implementation: Memory allocation failed\n");
-            MPI_Abort(MPI_COMM_WORLD, 1);
+        printf("Load imbalance (max/avg busy): %.2f\n\n", busy_max / (busy_sum / size));
+
+        double image_mb = (double)WIDTH * HEIGHT * 3 / (1024.0 * 1024.0);
+        printf("Parallel write (MPI-IO): %.3f ms, %.1f MB/s%s\n", max_write_time * 1000,
+               image_mb / max_write_time, write_ok ? "" : " (FAILED)");
+
+        // The speedup needs a real serial run: -S times one on rank 0
+        double serial_time = 0.0;
+        if (run_serial) {
+            int* serial_output = (int*)malloc((size_t)WIDTH * HEIGHT * sizeof(int));
+            if (serial_output == NULL) {
+                fprintf(stderr, "Serial implementation: Memory allocation failed\n");
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+
+            printf("Running serial implementation for comparison...\n");
+            serial_time = mandelbrotSerial(x0, y0, x1, y1, WIDTH, HEIGHT, MAX_ITERATIONS, serial_output);
+
+            // Write the serial output
+            writePPMImage(serial_output, WIDTH, HEIGHT, "mandelbrot_serial.ppm", MAX_ITERATIONS);
+            free(serial_output);
         }
         
-        printf("Running serial implementation for comparison...\n");
-        double serial_time = mandelbrotSerial(x0, y0, x1, y1, WIDTH, HEIGHT, MAX_ITERATIONS, serial_output);
-        
-        // Write the serial output
-        writePPMImage(serial_output, WIDTH, HEIGHT, "mandelbrot_serial.ppm", MAX_ITERATIONS);
-        
-        // Compare the results
-        int results_match = verifyResults(serial_output, full_output, WIDTH, HEIGHT);
-        
         // Report timings and speedup
-        printf("Parallel implementation: %.3f ms\n", max_parallel_time * 1000);
-        printf("Serial implementation: %.3f ms\n", serial_time * 1000);
-        printf("Speedup: %.2fx\n", serial_time / max_parallel_time);
+        printf("Parallel implementation: %.3f ms (%.1f Mpixels/s)\n", max_parallel_time * 1000,
+               (double)WIDTH * HEIGHT / max_parallel_time / 1e6);
+        if (run_serial) {
+            printf("Serial implementation: %.3f ms\n", serial_time * 1000);
+            printf("Speedup: %.2fx\n", serial_time / max_parallel_time);
+        } else {
+            printf("Speedup: not measured (-S times a serial run)\n");
+        }
         
         if (results_match) {
             printf("Results match between serial and parallel implementations.\n");
@@ -207,13 +539,23 @@ int main(int argc, char** argv) {
         }
         
         // Clean up
-        free(serial_output);
-        free(full_output);
-        free(gather_counts);
-        free(displacements);
+        free(all_stats);
+    }
+
+    // The other ranks sleep through rank 0's serial run instead of spinning in MPI on its cores
+    if (run_serial) {
+        MPI_Request serial_done;
+        int finished = 0;
+        MPI_Ibarrier(MPI_COMM_WORLD, &serial_done);
+        while (!finished) {
+            MPI_Test(&serial_done, &finished, MPI_STATUS_IGNORE);
+            if (!finished)
+                usleep(1000);
+        }
     }
     
+    free(my_rows);
     free(local_output);
     MPI_Finalize();
     return 0;
-}
\ No newline at end of file
+}
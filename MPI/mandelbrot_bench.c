@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mandel_kernels.h"
+
+/*
+    Single-core benchmark of the pixel kernels in mandel_kernels.h.
+    Every kernel renders the same views; pixels/sec is compared against the
+    scalar mandel() kernel and every output is checked against it pixel by pixel.
+
+    usage: ./mandelbrot_bench [width height max_iterations]
+*/
+
+typedef struct {
+    const char* name;
+    float x0, y0, x1, y1;
+} view;
+
+typedef struct {
+    const char* name;
+    rows_kernel kernel;
+    int band;       // rows handed to the kernel per call
+} kernel_entry;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Function to render a whole view with one kernel, band rows at a time
+static double render(const kernel_entry* k, const view* v, int width, int height,
+                     int maxIterations, int* output) {
+    float dx = (v->x1 - v->x0) / width;
+    float dy = (v->y1 - v->y0) / height;
+    double start = now();
+    for (int j = 0; j < height; j += k->band) {
+        int rows = j + k->band <= height ? k->band : height - j;
+        k->kernel(v->x0, v->y0, dx, dy, j, rows, width, maxIterations, output + (size_t)j * width);
+    }
+    return now() - start;
+}
+
+int main(int argc, char** argv) {
+    int width = 1600, height = 1200, maxIterations = 1024;
+    if (argc == 4) {
+        width = atoi(argv[1]);
+        height = atoi(argv[2]);
+        maxIterations = atoi(argv[3]);
+    } else if (argc != 1) {
+        fprintf(stderr, "Usage: %s [width height max_iterations]\n", argv[0]);
+        return 1;
+    }
+
+    // The first view is the one mandelbrot.c renders
+    const view views[] = {
+        { "full set",       -2.0f,   -1.0f,   1.0f,    1.0f },
+        { "seahorse valley", -0.80f, 0.05f,  -0.70f,   0.15f },
+        { "period-3 bulb",  -0.20f,   0.60f,   0.10f,   0.85f },
+    };
+    const kernel_entry kernels[] = {
+        { "scalar", mandelRows,     1 },
+#ifdef USE_ISPC
+        { "ispc",   mandelRowsISPC, 1 },
+#endif
+        { "fast",   mandelRowsFast, 1 },
+        { "fill",   mandelRowsFill, FILL_BAND_ROWS },
+    };
+    const int num_views = sizeof(views) / sizeof(views[0]);
+    const int num_kernels = sizeof(kernels) / sizeof(kernels[0]);
+
+    int* reference = (int*)malloc((size_t)width * height * sizeof(int));
+    int* output = (int*)malloc((size_t)width * height * sizeof(int));
+    if (reference == NULL || output == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return 1;
+    }
+
+    printf("Image size: %d x %d, Max iterations: %d\n", width, height, maxIterations);
+    int all_exact = 1;
+    for (int v = 0; v < num_views; v++) {
+        printf("\nView: %s [%g, %g] x [%g, %g]\n", views[v].name,
+               views[v].x0, views[v].x1, views[v].y0, views[v].y1);
+        printf("%-8s %12s %14s %9s %12s\n", "Kernel", "Time (ms)", "Mpixels/s", "Speedup", "Mismatches");
+
+        double scalar_time = render(&kernels[0], &views[v], width, height, maxIterations, reference);
+        for (int k = 0; k < num_kernels; k++) {
+            double t = scalar_time;
+            long mismatches = 0;
+            if (k > 0) {
+                t = render(&kernels[k], &views[v], width, height, maxIterations, output);
+                for (size_t p = 0; p < (size_t)width * height; p++)
+                    mismatches += output[p] != reference[p];
+            }
+            printf("%-8s %12.3f %14.2f %8.2fx %12ld\n", kernels[k].name, t * 1000,
+                   (double)width * height / t / 1e6, scalar_time / t, mismatches);
+            // Only the fill kernel is allowed to differ from mandelbrotSerial()
+            if (mismatches && kernels[k].kernel != mandelRowsFill)
+                all_exact = 0;
+        }
+    }
+
+    if (all_exact) {
+        printf("\nExact kernels match the scalar kernel on every pixel.\n");
+    } else {
+        printf("\nWARNING: an exact kernel does not match the scalar kernel!\n");
+    }
+
+    free(reference);
+    free(output);
+    return all_exact ? 0 : 1;
+}
@@ -0,0 +1,523 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <mpi.h>
+#include "mandel_kernels.h"
+#include "ppm_image.h"
+
+/*
+    Zoom-sequence renderer with a tile cache.
+
+    Instead of recomputing every frame of a zoom from scratch, the complex plane
+    is covered by a quad-tree of square tiles: at level L a tile of TxT pixels
+    spans SPAN / 2^L, with the grid anchored at (ORIGIN, ORIGIN). Each frame is
+    resampled from the level whose pixel size is closest to the frame's, so
+    consecutive frames of a zoom keep hitting the same tiles until the view has
+    shrunk by about 2x. Tiles are keyed by (level, tx, ty, max_iterations) and
+    kept in an LRU memory cache on rank 0 and, optionally, as files on disk so a
+    later job over the same region starts warm. Missing tiles of a frame are
+    computed by all ranks in parallel and gathered on rank 0.
+
+    usage: mpirun -np 4 ./mandelbrot_zoom [-f zoom.cfg] [key=value ...]
+    The settings file holds the same key=value pairs (one per line, # comments);
+    command line pairs override it. Keys are listed in usage().
+*/
+
+#define ORIGIN -2.0
+#define SPAN 4.0
+#define MAX_LEVEL 24        // float pixel coordinates stop resolving tiles beyond this
+#define NUM_BUCKETS 4096
+#define TILE_MAGIC 0x4c49544d
+
+typedef struct {
+    double center_x, center_y;
+    double view_width;      // width of the first frame in the complex plane
+    double zoom;            // view width multiplier from one frame to the next
+    int frames;
+    int width, height;
+    int max_iterations;
+    int tile_size;
+    int cache_tiles;        // memory cache size in tiles (grown if a frame needs more)
+    int fast;               // 1: mandelFast(), 0: mandel(); both give identical counts
+    char cache_dir[256];    // empty string disables the disk cache
+    char output_prefix[256];
+} zoom_config;
+
+typedef struct {
+    long long level, tx, ty;
+} tile_key;
+
+typedef struct {
+    tile_key key;
+    int* data;              // tile_size * tile_size iteration counts, NULL for an empty slot
+    long last_used;         // last frame that touched the tile
+    int next;               // next slot in the same hash bucket, -1 ends the chain
+} cache_slot;
+
+typedef struct {
+    cache_slot* slots;
+    int num_slots;
+    int buckets[NUM_BUCKETS];
+    int tile_size;
+    int max_iterations;
+    const char* dir;
+} tile_cache;
+
+// Per-frame counters for the cache report
+typedef struct {
+    long needed, memory_hits, disk_hits, computed;
+} frame_stats;
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-f settings_file] [key=value ...]\n", prog);
+    fprintf(stderr, "  center_x center_y view_width zoom frames width height max_iterations\n");
+    fprintf(stderr, "  tile_size cache_tiles kernel=scalar|fast cache_dir output_prefix\n");
+}
+
+static void defaultConfig(zoom_config* cfg) {
+    cfg->center_x = -0.743643887;
+    cfg->center_y = 0.131825904;
+    cfg->view_width = 3.0;
+    cfg->zoom = 0.95;
+    cfg->frames = 60;
+    cfg->width = 640;
+    cfg->height = 480;
+    cfg->max_iterations = 1024;
+    cfg->tile_size = 64;
+    cfg->cache_tiles = 4096;
+    cfg->fast = 1;
+    strcpy(cfg->cache_dir, "tile_cache");
+    strcpy(cfg->output_prefix, "zoom_");
+}
+
+// Function to apply one key=value setting, returns 0 for an unknown key or bad value
+static int applySetting(zoom_config* cfg, const char* key, const char* value) {
+    if (strcmp(key, "center_x") == 0) cfg->center_x = atof(value);
+    else if (strcmp(key, "center_y") == 0) cfg->center_y = atof(value);
+    else if (strcmp(key, "view_width") == 0) cfg->view_width = atof(value);
+    else if (strcmp(key, "zoom") == 0) cfg->zoom = atof(value);
+    else if (strcmp(key, "frames") == 0) cfg->frames = atoi(value);
+    else if (strcmp(key, "width") == 0) cfg->width = atoi(value);
+    else if (strcmp(key, "height") == 0) cfg->height = atoi(value);
+    else if (strcmp(key, "max_iterations") == 0) cfg->max_iterations = atoi(value);
+    else if (strcmp(key, "tile_size") == 0) cfg->tile_size = atoi(value);
+    else if (strcmp(key, "cache_tiles") == 0) cfg->cache_tiles = atoi(value);
+    else if (strcmp(key, "kernel") == 0) {
+        if (strcmp(value, "fast") == 0) cfg->fast = 1;
+        else if (strcmp(value, "scalar") == 0) cfg->fast = 0;
+        else return 0;
+    }
+    else if (strcmp(key, "cache_dir") == 0) snprintf(cfg->cache_dir, sizeof(cfg->cache_dir), "%s", value);
+    else if (strcmp(key, "output_prefix") == 0) snprintf(cfg->output_prefix, sizeof(cfg->output_prefix), "%s", value);
+    else return 0;
+    return 1;
+}
+
+// Function to split "key=value" (spaces around '=' allowed) and apply it
+static int applyPair(zoom_config* cfg, const char* pair) {
+    char key[64], value[256];
+    if (sscanf(pair, " %63[^= \t] = %255s", key, value) != 2)
+        return 0;
+    if (strcmp(value, "\"\"") == 0)
+        value[0] = '\0';
+    return applySetting(cfg, key, value);
+}
+
+static int loadConfigFile(zoom_config* cfg, const char* filename) {
+    FILE* fp = fopen(filename, "r");
+    if (!fp) {
+        fprintf(stderr, "Error: Unable to open settings file '%s'\n", filename);
+        return 0;
+    }
+    char line[512];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        line_number++;
+        char* comment = strchr(line, '#');
+        if (comment)
+            *comment = '\0';
+        if (strspn(line, " \t\r\n") == strlen(line))
+            continue;
+        if (!applyPair(cfg, line)) {
+            fprintf(stderr, "Error: %s:%d: bad setting '%s'\n", filename, line_number, line);
+            fclose(fp);
+            return 0;
+        }
+    }
+    fclose(fp);
+    return 1;
+}
+
+static int validConfig(const zoom_config* cfg) {
+    return cfg->frames > 0 && cfg->width > 0 && cfg->height > 0 && cfg->max_iterations > 0 &&
+           cfg->tile_size > 0 && cfg->cache_tiles > 0 && cfg->view_width > 0.0 && cfg->zoom > 0.0;
+}
+
+static long long floorDiv(long long a, long long b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+static double levelPixelSize(long long level, int tile_size) {
+    return SPAN / ((double)tile_size * ldexp(1.0, (int)level));
+}
+
+// Function to compute one tile; every pixel position depends only on the key so cached tiles are exact
+static void computeTile(const tile_key* key, int tile_size, int max_iterations, int fast, int* output) {
+    double ps = levelPixelSize(key->level, tile_size);
+    for (int j = 0; j < tile_size; j++) {
+        float y = (float)(ORIGIN + ((double)key->ty * tile_size + j + 0.5) * ps);
+        for (int i = 0; i < tile_size; i++) {
+            float x = (float)(ORIGIN + ((double)key->tx * tile_size + i + 0.5) * ps);
+            output[j * tile_size + i] = fast ? mandelFast(x, y, max_iterations) : mandel(x, y, max_iterations);
+        }
+    }
+}
+
+static unsigned hashKey(const tile_key* key) {
+    unsigned long long h = (unsigned long long)key->level * 0x9E3779B97F4A7C15ull;
+    h ^= (unsigned long long)key->tx * 0xC2B2AE3D27D4EB4Full + (h << 6) + (h >> 2);
+    h ^= (unsigned long long)key->ty * 0x165667B19E3779F9ull + (h << 6) + (h >> 2);
+    return (unsigned)(h % NUM_BUCKETS);
+}
+
+static int sameKey(const tile_key* a, const tile_key* b) {
+    return a->level == b->level && a->tx == b->tx && a->ty == b->ty;
+}
+
+static void cacheInit(tile_cache* cache, int num_slots, int tile_size, int max_iterations, const char* dir) {
+    cache->slots = (cache_slot*)calloc(num_slots, sizeof(cache_slot));
+    cache->num_slots = num_slots;
+    for (int b = 0; b < NUM_BUCKETS; b++)
+        cache->buckets[b] = -1;
+    cache->tile_size = tile_size;
+    cache->max_iterations = max_iterations;
+    cache->dir = (dir && dir[0]) ? dir : NULL;
+}
+
+static void cacheFree(tile_cache* cache) {
+    for (int s = 0; s < cache->num_slots; s++)
+        free(cache->slots[s].data);
+    free(cache->slots);
+}
+
+// Function to find a tile in memory, marking it used by the current frame
+static int* cacheLookup(tile_cache* cache, const tile_key* key, long frame) {
+    for (int s = cache->buckets[hashKey(key)]; s >= 0; s = cache->slots[s].next) {
+        if (sameKey(&cache->slots[s].key, key)) {
+            cache->slots[s].last_used = frame;
+            return cache->slots[s].data;
+        }
+    }
+    return NULL;
+}
+
+static void cacheUnlink(tile_cache* cache, int slot) {
+    int* link = &cache->buckets[hashKey(&cache->slots[slot].key)];
+    while (*link != slot)
+        link = &cache->slots[*link].next;
+    *link = cache->slots[slot].next;
+    free(cache->slots[slot].data);
+    cache->slots[slot].data = NULL;
+}
+
+/*
+    Function to store a tile (the cache takes ownership of data). The least
+    recently used tile is evicted when the cache is full; tiles used by the
+    current frame are never evicted, the cache grows instead.
+*/
+static int* cacheInsert(tile_cache* cache, const tile_key* key, int* data, long frame) {
+    int victim = -1;
+    for (int s = 0; s < cache->num_slots; s++) {
+        if (cache->slots[s].data == NULL) {
+            victim = s;
+            break;
+        }
+        if (cache->slots[s].last_used < frame &&
+            (victim < 0 || cache->slots[s].last_used < cache->slots[victim].last_used))
+            victim = s;
+    }
+    if (victim < 0) {
+        int grown = cache->num_slots * 2;
+        cache_slot* slots = (cache_slot*)realloc(cache->slots, grown * sizeof(cache_slot));
+        if (slots == NULL)
+            return NULL;
+        memset(slots + cache->num_slots, 0, (grown - cache->num_slots) * sizeof(cache_slot));
+        victim = cache->num_slots;
+        cache->slots = slots;
+        cache->num_slots = grown;
+    } else if (cache->slots[victim].data != NULL) {
+        cacheUnlink(cache, victim);
+    }
+
+    unsigned b = hashKey(key);
+    cache->slots[victim].key = *key;
+    cache->slots[victim].data = data;
+    cache->slots[victim].last_used = frame;
+    cache->slots[victim].next = cache->buckets[b];
+    cache->buckets[b] = victim;
+    return data;
+}
+
+static void tilePath(const tile_cache* cache, const tile_key* key, char* path, size_t len) {
+    snprintf(path, len, "%s/L%lld_%lld_%lld_i%d_t%d.tile", cache->dir, key->level, key->tx, key->ty,
+             cache->max_iterations, cache->tile_size);
+}
+
+// Function to read a tile from the disk cache into data, returns 1 if it was there and valid
+static int diskLoad(const tile_cache* cache, const tile_key* key, int* data) {
+    if (cache->dir == NULL)
+        return 0;
+    char path[512];
+    tilePath(cache, key, path, sizeof(path));
+    FILE* fp = fopen(path, "rb");
+    if (!fp)
+        return 0;
+    int header[3];
+    size_t pixels = (size_t)cache->tile_size * cache->tile_size;
+    int ok = fread(header, sizeof(int), 3, fp) == 3 && header[0] == TILE_MAGIC &&
+             header[1] == cache->tile_size && header[2] == cache->max_iterations &&
+             fread(data, sizeof(int), pixels, fp) == pixels;
+    fclose(fp);
+    return ok;
+}
+
+static void diskStore(const tile_cache* cache, const tile_key* key, const int* data) {
+    if (cache->dir == NULL)
+        return;
+    char path[512];
+    tilePath(cache, key, path, sizeof(path));
+    FILE* fp = fopen(path, "wb");
+    if (!fp)
+        return;
+    int header[3] = { TILE_MAGIC, cache->tile_size, cache->max_iterations };
+    fwrite(header, sizeof(int), 3, fp);
+    fwrite(data, sizeof(int), (size_t)cache->tile_size * cache->tile_size, fp);
+    fclose(fp);
+}
+
+int main(int argc, char** argv) {
+    int rank, size;
+    zoom_config cfg;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Rank 0 reads the settings (the file may only exist on its node) and broadcasts them
+    int config_ok = 1;
+    if (rank == 0) {
+        defaultConfig(&cfg);
+        for (int a = 1; a < argc && config_ok; a++) {
+            if (strcmp(argv[a], "-f") == 0 && a + 1 < argc) {
+                config_ok = loadConfigFile(&cfg, argv[++a]);
+            } else if (!applyPair(&cfg, argv[a])) {
+                fprintf(stderr, "Error: bad argument '%s'\n", argv[a]);
+                config_ok = 0;
+            }
+        }
+        if (config_ok && !validConfig(&cfg)) {
+            fprintf(stderr, "Error: sizes, frames and zoom must be positive\n");
+            config_ok = 0;
+        }
+        if (!config_ok)
+            usage(argv[0]);
+    }
+    MPI_Bcast(&config_ok, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (!config_ok) {
+        MPI_Finalize();
+        return 1;
+    }
+    MPI_Bcast(&cfg, sizeof(cfg), MPI_BYTE, 0, MPI_COMM_WORLD);
+
+    const int T = cfg.tile_size;
+    const size_t tile_pixels = (size_t)T * T;
+    tile_cache cache;
+    int* frame = NULL;
+    if (rank == 0) {
+        if (cfg.cache_dir[0] && mkdir(cfg.cache_dir, 0755) != 0 && errno != EEXIST) {
+            fprintf(stderr, "Warning: cannot create '%s', disk cache disabled\n", cfg.cache_dir);
+            cfg.cache_dir[0] = '\0';
+        }
+        cacheInit(&cache, cfg.cache_tiles, T, cfg.max_iterations, cfg.cache_dir);
+        frame = (int*)malloc((size_t)cfg.width * cfg.height * sizeof(int));
+        if (frame == NULL || cache.slots == NULL) {
+            fprintf(stderr, "Master process: Memory allocation failed\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        printf("Zoom renderer with %d MPI processes\n", size);
+        printf("Frames: %d of %d x %d, Max iterations: %d, Tile: %dx%d, Kernel: %s\n",
+               cfg.frames, cfg.width, cfg.height, cfg.max_iterations, T, T, cfg.fast ? "fast" : "scalar");
+        printf("Disk cache: %s\n\n", cfg.cache_dir[0] ? cfg.cache_dir : "disabled");
+        printf("%6s %6s %7s %7s %7s %9s %12s\n", "Frame", "Level", "Tiles", "Memory", "Disk", "Computed", "Time (ms)");
+    }
+
+    frame_stats total = { 0, 0, 0, 0 };
+    double total_start = MPI_Wtime();
+
+    for (long f = 0; f < cfg.frames; f++) {
+        double frame_start = MPI_Wtime();
+        frame_stats stats = { 0, 0, 0, 0 };
+        tile_key* missing = NULL;
+        int num_missing = 0;
+        int** frame_tiles = NULL;
+        long long tx0 = 0, ty0 = 0, ntx = 0, nty = 0, level = 0;
+        double fx0 = 0.0, fy0 = 0.0, fps = 0.0;
+
+        if (rank == 0) {
+            // Frame window and the tile level closest to its pixel size
+            double view_width = cfg.view_width * pow(cfg.zoom, (double)f);
+            fps = view_width / cfg.width;
+            fx0 = cfg.center_x - 0.5 * view_width;
+            fy0 = cfg.center_y - 0.5 * fps * cfg.height;
+            level = llround(log2(SPAN / (T * fps)));
+            if (level < 0) level = 0;
+            if (level > MAX_LEVEL) level = MAX_LEVEL;
+            double ps = levelPixelSize(level, T);
+
+            tx0 = floorDiv((long long)floor((fx0 + 0.5 * fps - ORIGIN) / ps), T);
+            ty0 = floorDiv((long long)floor((fy0 + 0.5 * fps - ORIGIN) / ps), T);
+            long long tx1 = floorDiv((long long)floor((fx0 + (cfg.width - 0.5) * fps - ORIGIN) / ps), T);
+            long long ty1 = floorDiv((long long)floor((fy0 + (cfg.height - 0.5) * fps - ORIGIN) / ps), T);
+            ntx = tx1 - tx0 + 1;
+            nty = ty1 - ty0 + 1;
+            stats.needed = ntx * nty;
+
+            // Memory first, then disk; whatever is left is computed by all ranks
+            frame_tiles = (int**)calloc(stats.needed, sizeof(int*));
+            missing = (tile_key*)malloc(stats.needed * sizeof(tile_key));
+            if (frame_tiles == NULL || missing == NULL) {
+                fprintf(stderr, "Master process: Memory allocation failed\n");
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            for (long long ty = 0; ty < nty; ty++) {
+                for (long long tx = 0; tx < ntx; tx++) {
+                    tile_key key = { level, tx0 + tx, ty0 + ty };
+                    int* data = cacheLookup(&cache, &key, f);
+                    if (data) {
+                        stats.memory_hits++;
+                    } else {
+                        data = (int*)malloc(tile_pixels * sizeof(int));
+                        if (data && diskLoad(&cache, &key, data)) {
+                            if (cacheInsert(&cache, &key, data, f) == NULL) {
+                                fprintf(stderr, "Master process: Memory allocation failed\n");
+                                MPI_Abort(MPI_COMM_WORLD, 1);
+                            }
+                            stats.disk_hits++;
+                        } else {
+                            free(data);
+                            data = NULL;
+                            missing[num_missing++] = key;
+                        }
+                    }
+                    frame_tiles[ty * ntx + tx] = data;
+                }
+            }
+        }
+
+        // Distribute the missing tiles round-robin over all ranks
+        MPI_Bcast(&num_missing, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        if (rank != 0)
+            missing = (tile_key*)malloc((num_missing + 1) * sizeof(tile_key));
+        MPI_Bcast(missing, num_missing * 3, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+
+        int my_tiles = num_missing / size + (rank < num_missing % size ? 1 : 0);
+        int* computed = (int*)malloc(((size_t)my_tiles * tile_pixels + 1) * sizeof(int));
+        if (computed == NULL || missing == NULL) {
+            fprintf(stderr, "Process %d: Memory allocation failed\n", rank);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        for (int k = 0; k < my_tiles; k++)
+            computeTile(&missing[rank + k * size], T, cfg.max_iterations, cfg.fast,
+                        computed + (size_t)k * tile_pixels);
+
+        int* counts = NULL;
+        int* displacements = NULL;
+        int* gathered = NULL;
+        if (rank == 0) {
+            counts = (int*)malloc(size * sizeof(int));
+            displacements = (int*)malloc(size * sizeof(int));
+            gathered = (int*)malloc(((size_t)num_missing * tile_pixels + 1) * sizeof(int));
+            if (counts == NULL || displacements == NULL || gathered == NULL) {
+                fprintf(stderr, "Master process: Memory allocation failed\n");
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            int offset = 0;
+            for (int r = 0; r < size; r++) {
+                counts[r] = (num_missing / size + (r < num_missing % size ? 1 : 0)) * (int)tile_pixels;
+                displacements[r] = offset;
+                offset += counts[r];
+            }
+        }
+        MPI_Gatherv(computed, my_tiles * (int)tile_pixels, MPI_INT,
+                    gathered, counts, displacements, MPI_INT, 0, MPI_COMM_WORLD);
+
+        if (rank == 0) {
+            // Rank r's k-th tile is missing[r + k * size]
+            for (int r = 0; r < size; r++) {
+                for (int k = 0; r + k * size < num_missing; k++) {
+                    tile_key* key = &missing[r + k * size];
+                    int* data = (int*)malloc(tile_pixels * sizeof(int));
+                    if (data == NULL || cacheInsert(&cache, key, data, f) == NULL) {
+                        fprintf(stderr, "Master process: Memory allocation failed\n");
+                        MPI_Abort(MPI_COMM_WORLD, 1);
+                    }
+                    memcpy(data, gathered + displacements[r] + (size_t)k * tile_pixels, tile_pixels * sizeof(int));
+                    diskStore(&cache, key, data);
+                    frame_tiles[(key->ty - ty0) * ntx + (key->tx - tx0)] = data;
+                    stats.computed++;
+                }
+            }
+
+            // Resample the frame from the tiles (nearest tile pixel to each frame pixel centre)
+            double ps = levelPixelSize(level, T);
+            for (int j = 0; j < cfg.height; j++) {
+                long long gy = (long long)floor((fy0 + (j + 0.5) * fps - ORIGIN) / ps);
+                long long ty = floorDiv(gy, T);
+                int py = (int)(gy - ty * T);
+                for (int i = 0; i < cfg.width; i++) {
+                    long long gx = (long long)floor((fx0 + (i + 0.5) * fps - ORIGIN) / ps);
+                    long long tx = floorDiv(gx, T);
+                    int px = (int)(gx - tx * T);
+                    const int* tile = frame_tiles[(ty - ty0) * ntx + (tx - tx0)];
+                    frame[(size_t)j * cfg.width + i] = tile[py * T + px];
+                }
+            }
+
+            char filename[300];
+            snprintf(filename, sizeof(filename), "%s%04ld.ppm", cfg.output_prefix, f);
+            writePPMImage(frame, cfg.width, cfg.height, filename, cfg.max_iterations);
+
+            printf("%6ld %6lld %7ld %7ld %7ld %9ld %12.3f\n", f, level, stats.needed, stats.memory_hits,
+                   stats.disk_hits, stats.computed, (MPI_Wtime() - frame_start) * 1000);
+            total.needed += stats.needed;
+            total.memory_hits += stats.memory_hits;
+            total.disk_hits += stats.disk_hits;
+            total.computed += stats.computed;
+
+            free(counts);
+            free(displacements);
+            free(gathered);
+            free(frame_tiles);
+        }
+        free(computed);
+        free(missing);
+    }
+
+    double total_time = MPI_Wtime() - total_start;
+    if (rank == 0) {
+        printf("\nTotal: %.3f ms for %d frames (%.1f frames/s)\n", total_time * 1000, cfg.frames,
+               cfg.frames / total_time);
+        printf("Tiles requested: %ld, memory hits: %ld, disk hits: %ld, computed: %ld\n",
+               total.needed, total.memory_hits, total.disk_hits, total.computed);
+        printf("Tile reuse: %.1f%% of tile requests served from cache\n",
+               total.needed ? 100.0 * (total.memory_hits + total.disk_hits) / total.needed : 0.0);
+        cacheFree(&cache);
+        free(frame);
+    }
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,330 @@
+// mapreduce.h
+// Small in-memory MapReduce engine on MPI (header only, C++17)
+#ifndef MAPREDUCE_H
+#define MAPREDUCE_H
+
+#include <mpi.h>
+#include <vector>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
+#include <functional>
+#include <type_traits>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+/*
+    Usage:
+        mr::Job<std::string, long long> job(MPI_COMM_WORLD);
+        job.set_combiner([](long long& acc, const long long& v) { acc += v; });
+        job.map(documents, [](const Doc& d, auto& job) { job.emit(word, 1); });
+        auto counts = job.reduce<long long>([](const std::string& word, const std::vector<long long>& v) {...});
+        job.print_stats("word count");
+
+    Phases (every rank runs all of them, reduce() and print_stats() are collective):
+      map      user map(input, job) calls job.emit(key, value). With a combiner the
+               pairs are merged per key on the spot, so each rank ships one value
+               per distinct key instead of one per emit.
+      shuffle  pairs are serialized into one buffer per destination rank, chosen
+               by hashing the key, and exchanged with MPI_Alltoall (byte counts)
+               + MPI_Alltoallv (payload).
+      sort     each rank sorts the pairs of its partition by key in memory.
+      reduce   user reduce(key, values) runs once per distinct key; the result
+               stays on the rank owning the partition, sorted by key.
+    gather() collects all partitions on one rank.
+
+    Keys need std::hash, operator< and operator==. Keys and values are sent
+    through mr::Serializer: trivially copyable types, std::string and
+    std::vector<T> work out of the box, other types need a specialization.
+    A single rank's send or receive buffer must stay below 2 GB (int counts).
+*/
+
+namespace mr {
+
+// ---------------------------------------------------------------- serialization
+
+template <typename T>
+struct Serializer {
+    static_assert(std::is_trivially_copyable<T>::value, "specialize mr::Serializer for this type");
+    static void write(std::vector<char>& out, const T& value) {
+        const char* p = reinterpret_cast<const char*>(&value);
+        out.insert(out.end(), p, p + sizeof(T));
+    }
+    static T read(const char*& in) {
+        T value;
+        std::memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return value;
+    }
+};
+
+template <>
+struct Serializer<std::string> {
+    static void write(std::vector<char>& out, const std::string& s) {
+        Serializer<uint32_t>::write(out, (uint32_t)s.size());
+        out.insert(out.end(), s.begin(), s.end());
+    }
+    static std::string read(const char*& in) {
+        uint32_t size = Serializer<uint32_t>::read(in);
+        std::string s(in, size);
+        in += size;
+        return s;
+    }
+};
+
+template <typename T>
+struct Serializer<std::vector<T>> {
+    static void write(std::vector<char>& out, const std::vector<T>& v) {
+        Serializer<uint64_t>::write(out, (uint64_t)v.size());
+        for (const T& x : v)
+            Serializer<T>::write(out, x);
+    }
+    static std::vector<T> read(const char*& in) {
+        uint64_t size = Serializer<uint64_t>::read(in);
+        std::vector<T> v;
+        v.reserve(size);
+        for (uint64_t i = 0; i < size; i++)
+            v.push_back(Serializer<T>::read(in));
+        return v;
+    }
+};
+
+// ---------------------------------------------------------------- exchange
+
+// Function to exchange one byte buffer per destination rank, returns everything received
+inline std::vector<char> exchange(const std::vector<std::vector<char>>& outgoing, MPI_Comm comm) {
+    int size;
+    MPI_Comm_size(comm, &size);
+    std::vector<int> send_counts(size), recv_counts(size), send_displs(size), recv_displs(size);
+    size_t send_total = 0;
+    for (int r = 0; r < size; r++) {
+        send_total += outgoing[r].size();
+        send_counts[r] = (int)outgoing[r].size();
+    }
+    if (send_total > INT_MAX) {
+        fprintf(stderr, "mr::exchange: more than 2 GB to send from one rank\n");
+        MPI_Abort(comm, 1);
+    }
+    MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, comm);
+
+    size_t recv_total = 0;
+    for (int r = 0; r < size; r++) {
+        recv_displs[r] = (int)recv_total;
+        recv_total += recv_counts[r];
+    }
+    if (recv_total > INT_MAX) {
+        fprintf(stderr, "mr::exchange: more than 2 GB to receive on one rank\n");
+        MPI_Abort(comm, 1);
+    }
+
+    std::vector<char> send;
+    send.reserve(send_total);
+    for (int r = 0; r < size; r++) {
+        send_displs[r] = (int)send.size();
+        send.insert(send.end(), outgoing[r].begin(), outgoing[r].end());
+    }
+    std::vector<char> received(recv_total);
+    MPI_Alltoallv(send.data(), send_counts.data(), send_displs.data(), MPI_BYTE,
+                  received.data(), recv_counts.data(), recv_displs.data(), MPI_BYTE, comm);
+    return received;
+}
+
+// ---------------------------------------------------------------- job
+
+struct Stats {
+    double map_time = 0, shuffle_time = 0, sort_time = 0, reduce_time = 0;
+    long long emitted = 0;          // pairs emitted by map
+    long long sent_pairs = 0;       // pairs after the combiner, i.e. shuffled
+    long long sent_bytes = 0;
+    long long keys = 0;             // distinct keys reduced on this rank
+};
+
+template <typename K, typename V>
+class Job {
+public:
+    using Combiner = std::function<void(V&, const V&)>;
+
+    explicit Job(MPI_Comm comm) : comm_(comm) {
+        MPI_Comm_rank(comm_, &rank_);
+        MPI_Comm_size(comm_, &size_);
+    }
+
+    // acc = combine(acc, value); must be associative and commutative
+    void set_combiner(Combiner combiner) { combiner_ = std::move(combiner); }
+
+    void emit(const K& key, const V& value) {
+        stats_.emitted++;
+        if (combiner_) {
+            auto it = combined_.find(key);
+            if (it == combined_.end())
+                combined_.emplace(key, value);
+            else
+                combiner_(it->second, value);
+        } else {
+            pairs_.emplace_back(key, value);
+        }
+    }
+
+    // Function to run map(input, *this) over the local inputs; may be called several times
+    template <typename Input, typename Map>
+    void map(const std::vector<Input>& inputs, Map map_fn) {
+        double start = MPI_Wtime();
+        for (const Input& input : inputs)
+            map_fn(input, *this);
+        stats_.map_time += MPI_Wtime() - start;
+    }
+
+    /*
+        Function to shuffle, sort and reduce. reduce(key, values) -> R is called once per
+        distinct key of this rank's partition. Returns the partition's (key, R) pairs
+        sorted by key. Collective.
+    */
+    template <typename R, typename Reduce>
+    std::vector<std::pair<K, R>> reduce(Reduce reduce_fn) {
+        std::vector<std::pair<K, V>> partition = shuffle();
+
+        double start = MPI_Wtime();
+        std::sort(partition.begin(), partition.end(),
+                  [](const std::pair<K, V>& a, const std::pair<K, V>& b) { return a.first < b.first; });
+        stats_.sort_time += MPI_Wtime() - start;
+
+        start = MPI_Wtime();
+        std::vector<std::pair<K, R>> results;
+        std::vector<V> values;
+        for (size_t i = 0; i < partition.size();) {
+            size_t j = i;
+            values.clear();
+            while (j < partition.size() && partition[j].first == partition[i].first)
+                values.push_back(std::move(partition[j++].second));
+            results.emplace_back(partition[i].first, reduce_fn(partition[i].first, values));
+            i = j;
+        }
+        stats_.keys += (long long)results.size();
+        stats_.reduce_time += MPI_Wtime() - start;
+        return results;
+    }
+
+    const Stats& stats() const { return stats_; }
+
+    // Function to print the slowest rank's phase times and total traffic on rank 0. Collective.
+    void print_stats(const char* title) const {
+        double times[4] = { stats_.map_time, stats_.shuffle_time, stats_.sort_time, stats_.reduce_time };
+        double max_times[4];
+        long long counts[4] = { stats_.emitted, stats_.sent_pairs, stats_.sent_bytes, stats_.keys };
+        long long totals[4];
+        MPI_Reduce(times, max_times, 4, MPI_DOUBLE, MPI_MAX, 0, comm_);
+        MPI_Reduce(counts, totals, 4, MPI_LONG_LONG, MPI_SUM, 0, comm_);
+        if (rank_ == 0) {
+            printf("%s (%d processes, %s)\n", title, size_, combiner_ ? "with combiner" : "no combiner");
+            printf("  map:     %9.3f ms  %lld pairs emitted\n", max_times[0] * 1e3, totals[0]);
+            printf("  shuffle: %9.3f ms  %lld pairs, %.2f MB\n", max_times[1] * 1e3, totals[1], totals[2] / 1e6);
+            printf("  sort:    %9.3f ms\n", max_times[2] * 1e3);
+            printf("  reduce:  %9.3f ms  %lld keys\n", max_times[3] * 1e3, totals[3]);
+            printf("  total:   %9.3f ms (slowest process per phase)\n",
+                   (max_times[0] + max_times[1] + max_times[2] + max_times[3]) * 1e3);
+        }
+    }
+
+private:
+    // Partition by key hash; the multiply spreads identity hashes of small integers
+    int owner(const K& key) const {
+        uint64_t h = (uint64_t)std::hash<K>()(key) * 0x9E3779B97F4A7C15ULL;
+        return (int)((h >> 32) % (uint64_t)size_);
+    }
+
+    std::vector<std::pair<K, V>> shuffle() {
+        double start = MPI_Wtime();
+        std::vector<std::vector<char>> outgoing(size_);
+        auto pack = [&](const K& key, const V& value) {
+            std::vector<char>& out = outgoing[owner(key)];
+            Serializer<K>::write(out, key);
+            Serializer<V>::write(out, value);
+            stats_.sent_pairs++;
+        };
+        for (const auto& kv : combined_)
+            pack(kv.first, kv.second);
+        for (const auto& kv : pairs_)
+            pack(kv.first, kv.second);
+        combined_.clear();
+        pairs_.clear();
+        for (const auto& out : outgoing)
+            stats_.sent_bytes += (long long)out.size();
+
+        std::vector<char> received = mr::exchange(outgoing, comm_);
+        outgoing.clear();
+
+        std::vector<std::pair<K, V>> partition;
+        const char* in = received.data();
+        const char* end = in + received.size();
+        while (in < end) {
+            K key = Serializer<K>::read(in);
+            V value = Serializer<V>::read(in);
+            partition.emplace_back(std::move(key), std::move(value));
+        }
+        stats_.shuffle_time += MPI_Wtime() - start;
+        return partition;
+    }
+
+    MPI_Comm comm_;
+    int rank_ = 0, size_ = 1;
+    Combiner combiner_;
+    std::unordered_map<K, V> combined_;
+    std::vector<std::pair<K, V>> pairs_;
+    Stats stats_;
+};
+
+// Function to collect every rank's results on root, sorted by key (empty on other ranks). Collective.
+template <typename K, typename R>
+std::vector<std::pair<K, R>> gather(const std::vector<std::pair<K, R>>& local, MPI_Comm comm, int root = 0) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    std::vector<char> send;
+    for (const auto& kv : local) {
+        Serializer<K>::write(send, kv.first);
+        Serializer<R>::write(send, kv.second);
+    }
+    if (send.size() > INT_MAX) {
+        fprintf(stderr, "mr::gather: more than 2 GB of results on one rank\n");
+        MPI_Abort(comm, 1);
+    }
+    int count = (int)send.size();
+    std::vector<int> counts(size), displs(size);
+    MPI_Gather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, root, comm);
+
+    std::vector<char> received;
+    if (rank == root) {
+        size_t total = 0;
+        for (int r = 0; r < size; r++) {
+            displs[r] = (int)total;
+            total += counts[r];
+        }
+        if (total > INT_MAX) {
+            fprintf(stderr, "mr::gather: more than 2 GB of results on the root\n");
+            MPI_Abort(comm, 1);
+        }
+        received.resize(total);
+    }
+    MPI_Gatherv(send.data(), count, MPI_BYTE, received.data(), counts.data(), displs.data(),
+                MPI_BYTE, root, comm);
+
+    std::vector<std::pair<K, R>> all;
+    const char* in = received.data();
+    const char* end = in + received.size();
+    while (in < end) {
+        K key = Serializer<K>::read(in);
+        R value = Serializer<R>::read(in);
+        all.emplace_back(std::move(key), std::move(value));
+    }
+    std::sort(all.begin(), all.end(),
+              [](const std::pair<K, R>& a, const std::pair<K, R>& b) { return a.first < b.first; });
+    return all;
+}
+
+} // namespace mr
+
+#endif
@@ -0,0 +1,354 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <unistd.h>
+#include <mpi.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_set>
+#include "mapreduce.h"
+#include "splitmix64.h"
+
+using namespace std;
+
+/*
+    Key-value jobs on the mapreduce.h engine:
+        wordcount   word -> number of occurrences
+        histogram   bin of a normally distributed value -> count
+        index       word -> sorted list of the documents containing it
+
+    Input is synthetic unless -f is given: document d has -w words drawn from a
+    Zipf-like (log-uniform) vocabulary of -v words, generated from (seed, d,
+    position) with the counter-based RNG of MapReduce_Simulation.c, so every rank
+    builds its own documents and the corpus is the same for any -np. With -f,
+    every line of the file is a document and rank r reads lines r, r+np, ...
+
+    Every job prints per-phase timings (slowest process), checks its totals
+    against counts taken during the map phase, and shows a few results.
+    -c disables the local combiners to show how much shuffle traffic they save.
+
+    mpicxx -O2 -std=c++17 mapreduce_examples.cpp -o mapreduce_examples
+    mpirun -np 4 ./mapreduce_examples [-j wordcount|histogram|index|all] [-c] [-f file]
+                                      [-d docs] [-w words] [-v vocabulary] [-n values] [-s seed]
+*/
+
+#define MASTER 0
+#define DEFAULT_DOCS 20000
+#define DEFAULT_WORDS 100
+#define DEFAULT_VOCABULARY 50000
+#define DEFAULT_VALUES 10000000
+#define DEFAULT_SEED 2024
+#define HISTOGRAM_BINS 32
+#define HISTOGRAM_RANGE 4.0     // bins cover [-4, 4), values outside go to the end bins
+#define VALUE_BLOCK (1 << 16)   // histogram values generated per map input
+#define TOP 10
+
+struct Document {
+    int id;
+    vector<string> words;
+};
+
+// One histogram map input: a range of value indices, generated inside map
+struct ValueRange {
+    long long begin, end;
+};
+
+// Uniform double in (0, 1) for counter i of stream (seed, stream)
+static inline double uniform(uint64_t seed, uint64_t stream, uint64_t i) {
+    uint64_t bits = mix64(i + mix64(stream + seed * 0xD1B54A32D192ED03ULL));
+    return ((bits >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+// Function to split [0, n) into contiguous slices, the first n % size ranks get one more
+static void slice(long long n, int rank, int size, long long* begin, long long* end) {
+    long long per_rank = n / size, remainder = n % size;
+    *begin = rank * per_rank + (rank < remainder ? rank : remainder);
+    *end = *begin + per_rank + (rank < remainder ? 1 : 0);
+}
+
+// Function to generate this rank's synthetic documents: word index = floor(V^u) - 1, u uniform
+static vector<Document> generate_documents(int rank, int size, long long docs, int words, int vocabulary,
+                                           uint64_t seed) {
+    long long begin, end;
+    slice(docs, rank, size, &begin, &end);
+    vector<Document> documents;
+    documents.reserve(end - begin);
+    double log_vocabulary = log((double)vocabulary);
+    for (long long d = begin; d < end; d++) {
+        Document doc;
+        doc.id = (int)d;
+        doc.words.reserve(words);
+        for (int k = 0; k < words; k++) {
+            double u = uniform(seed, (uint64_t)d, (uint64_t)k);
+            int w = min(vocabulary - 1, (int)exp(u * log_vocabulary) - 1);
+            doc.words.push_back("w" + to_string(w));
+        }
+        documents.push_back(std::move(doc));
+    }
+    return documents;
+}
+
+// Function to read this rank's lines of a text file, one document per line, lowercase words
+static vector<Document> read_documents(const char* path, int rank, int size) {
+    ifstream in(path);
+    if (!in) {
+        fprintf(stderr, "Cannot open %s on process %d\n", path, rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    vector<Document> documents;
+    string line;
+    for (int line_number = 0; getline(in, line); line_number++) {
+        if (line_number % size != rank)
+            continue;
+        Document doc;
+        doc.id = line_number;
+        string word;
+        for (char c : line) {
+            if (isalnum((unsigned char)c)) {
+                word += (char)tolower((unsigned char)c);
+            } else if (!word.empty()) {
+                doc.words.push_back(word);
+                word.clear();
+            }
+        }
+        if (!word.empty())
+            doc.words.push_back(word);
+        documents.push_back(std::move(doc));
+    }
+    return documents;
+}
+
+static void report(int rank, bool ok) {
+    int all_ok = 0, mine = ok;
+    MPI_Reduce(&mine, &all_ok, 1, MPI_INT, MPI_LAND, MASTER, MPI_COMM_WORLD);
+    if (rank == MASTER)
+        printf("  %s\n\n", all_ok ? "Totals verified" : "Totals are incorrect");
+}
+
+// Word count: (word, 1) per occurrence, summed by the combiner and the reducer
+static void word_count(const vector<Document>& documents, bool combine, int rank) {
+    mr::Job<string, long long> job(MPI_COMM_WORLD);
+    if (combine)
+        job.set_combiner([](long long& acc, const long long& v) { acc += v; });
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    job.map(documents, [](const Document& doc, mr::Job<string, long long>& out) {
+        for (const string& word : doc.words)
+            out.emit(word, 1);
+    });
+    auto counts = job.reduce<long long>([](const string&, const vector<long long>& values) {
+        long long sum = 0;
+        for (long long v : values)
+            sum += v;
+        return sum;
+    });
+    job.print_stats("Word count");
+
+    long long local_total = 0, total = 0, emitted = job.stats().emitted, words = 0;
+    for (const auto& kv : counts)
+        local_total += kv.second;
+    MPI_Allreduce(&local_total, &total, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&emitted, &words, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+
+    auto all = mr::gather(counts, MPI_COMM_WORLD);
+    if (rank == MASTER) {
+        sort(all.begin(), all.end(), [](const pair<string, long long>& a, const pair<string, long long>& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        printf("  %zu distinct words, %lld words, most frequent:", all.size(), total);
+        for (size_t i = 0; i < all.size() && i < TOP; i++)
+            printf(" %s=%lld", all[i].first.c_str(), all[i].second);
+        printf("\n");
+    }
+    report(rank, total == words);
+}
+
+// Histogram: values generated from their global index, (bin, 1) per value
+static void histogram(long long n, uint64_t seed, bool combine, int rank, int size) {
+    long long begin, end;
+    slice(n, rank, size, &begin, &end);
+    vector<ValueRange> ranges;
+    for (long long b = begin; b < end; b += VALUE_BLOCK)
+        ranges.push_back({ b, min(end, b + VALUE_BLOCK) });
+
+    mr::Job<int, long long> job(MPI_COMM_WORLD);
+    if (combine)
+        job.set_combiner([](long long& acc, const long long& v) { acc += v; });
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    job.map(ranges, [seed](const ValueRange& range, mr::Job<int, long long>& out) {
+        for (long long i = range.begin; i < range.end; i++) {
+            // Box-Muller, one standard normal value per index
+            double u1 = uniform(seed, 1ULL << 62, 2 * (uint64_t)i);
+            double u2 = uniform(seed, 1ULL << 62, 2 * (uint64_t)i + 1);
+            double value = sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+            int bin = (int)floor((value + HISTOGRAM_RANGE) * HISTOGRAM_BINS / (2 * HISTOGRAM_RANGE));
+            out.emit(min(HISTOGRAM_BINS - 1, max(0, bin)), 1);
+        }
+    });
+    auto bins = job.reduce<long long>([](const int&, const vector<long long>& values) {
+        long long sum = 0;
+        for (long long v : values)
+            sum += v;
+        return sum;
+    });
+    job.print_stats("Histogram");
+
+    long long local_total = 0, total = 0;
+    for (const auto& kv : bins)
+        local_total += kv.second;
+    MPI_Allreduce(&local_total, &total, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+
+    auto all = mr::gather(bins, MPI_COMM_WORLD);
+    if (rank == MASTER) {
+        long long peak = 1;
+        for (const auto& kv : all)
+            peak = max(peak, kv.second);
+        for (const auto& kv : all) {
+            double left = -HISTOGRAM_RANGE + kv.first * (2 * HISTOGRAM_RANGE / HISTOGRAM_BINS);
+            printf("  %+5.2f %10lld %s\n", left, kv.second, string((size_t)(50 * kv.second / peak), '#').c_str());
+        }
+    }
+    report(rank, total == n);
+}
+
+// Inverted index: (word, {doc}) once per distinct word of a document, lists merged and sorted
+static void inverted_index(const vector<Document>& documents, bool combine, int rank) {
+    mr::Job<string, vector<int>> job(MPI_COMM_WORLD);
+    if (combine)
+        job.set_combiner([](vector<int>& acc, const vector<int>& v) { acc.insert(acc.end(), v.begin(), v.end()); });
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    job.map(documents, [](const Document& doc, mr::Job<string, vector<int>>& out) {
+        unordered_set<string> seen;
+        for (const string& word : doc.words) {
+            if (seen.insert(word).second)
+                out.emit(word, vector<int>(1, doc.id));
+        }
+    });
+    auto index = job.reduce<vector<int>>([](const string&, const vector<vector<int>>& lists) {
+        vector<int> postings;
+        for (const vector<int>& list : lists)
+            postings.insert(postings.end(), list.begin(), list.end());
+        sort(postings.begin(), postings.end());
+        return postings;
+    });
+    job.print_stats("Inverted index");
+
+    // every (word, document) pair must appear exactly once
+    long long local_postings = 0, postings = 0, emitted = job.stats().emitted, pairs = 0;
+    bool ok = true;
+    for (const auto& kv : index) {
+        local_postings += (long long)kv.second.size();
+        ok = ok && adjacent_find(kv.second.begin(), kv.second.end()) == kv.second.end();
+    }
+    MPI_Allreduce(&local_postings, &postings, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&emitted, &pairs, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+
+    // only the posting list lengths travel to the master
+    vector<pair<string, long long>> lengths;
+    for (const auto& kv : index)
+        lengths.emplace_back(kv.first, (long long)kv.second.size());
+    auto all = mr::gather(lengths, MPI_COMM_WORLD);
+    if (rank == MASTER) {
+        sort(all.begin(), all.end(), [](const pair<string, long long>& a, const pair<string, long long>& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        printf("  %zu words, %lld postings, widest lists:", all.size(), postings);
+        for (size_t i = 0; i < all.size() && i < TOP; i++)
+            printf(" %s(%lld)", all[i].first.c_str(), all[i].second);
+        printf("\n");
+    }
+    // first documents of the master's first list
+    if (rank == MASTER && !index.empty()) {
+        const auto& entry = index.front();
+        printf("  %s ->", entry.first.c_str());
+        for (size_t i = 0; i < entry.second.size() && i < 8; i++)
+            printf(" %d", entry.second[i]);
+        printf("%s\n", entry.second.size() > 8 ? " ..." : "");
+    }
+    report(rank, ok && postings == pairs);
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-j wordcount|histogram|index|all] [-c] [-f file] [-d docs] [-w words]\n", prog);
+    fprintf(stderr, "          [-v vocabulary] [-n values] [-s seed]\n");
+    fprintf(stderr, "  -j  job to run, default all\n");
+    fprintf(stderr, "  -c  no local combiners (every emitted pair is shuffled)\n");
+    fprintf(stderr, "  -f  text file, one document per line, instead of synthetic documents\n");
+    fprintf(stderr, "  -d  synthetic documents, default %d\n", DEFAULT_DOCS);
+    fprintf(stderr, "  -w  words per synthetic document, default %d\n", DEFAULT_WORDS);
+    fprintf(stderr, "  -v  synthetic vocabulary size, default %d\n", DEFAULT_VOCABULARY);
+    fprintf(stderr, "  -n  histogram values (e.g. 1e8), default %d\n", DEFAULT_VALUES);
+    fprintf(stderr, "  -s  seed, default %d\n", DEFAULT_SEED);
+}
+
+int main(int argc, char* argv[]) {
+    int rank, size;
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    string jobs = "all";
+    bool combine = true;
+    const char* file = NULL;
+    long long docs = DEFAULT_DOCS, values = DEFAULT_VALUES;
+    int words = DEFAULT_WORDS, vocabulary = DEFAULT_VOCABULARY;
+    uint64_t seed = DEFAULT_SEED;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:cf:d:w:v:n:s:")) != -1) {
+        switch (opt) {
+        case 'j': jobs = optarg; break;
+        case 'c': combine = false; break;
+        case 'f': file = optarg; break;
+        case 'd': docs = (long long)strtod(optarg, NULL); break;
+        case 'w': words = atoi(optarg); break;
+        case 'v': vocabulary = atoi(optarg); break;
+        case 'n': values = (long long)strtod(optarg, NULL); break;
+        case 's': seed = strtoull(optarg, NULL, 10); break;
+        default:
+            if (rank == MASTER) usage(argv[0]);
+            MPI_Finalize();
+            return 1;
+        }
+    }
+    bool run_words = jobs == "all" || jobs == "wordcount";
+    bool run_histogram = jobs == "all" || jobs == "histogram";
+    bool run_index = jobs == "all" || jobs == "index";
+    if ((!run_words && !run_histogram && !run_index) || docs < 1 || docs > INT_MAX || words < 1 ||
+        vocabulary < 1 || values < 1) {
+        if (rank == MASTER) usage(argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+
+    vector<Document> documents;
+    if (run_words || run_index) {
+        double start = MPI_Wtime();
+        documents = file ? read_documents(file, rank, size)
+                         : generate_documents(rank, size, docs, words, vocabulary, seed);
+        double elapsed = MPI_Wtime() - start, slowest = 0;
+        MPI_Reduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, MASTER, MPI_COMM_WORLD);
+        if (rank == MASTER) {
+            if (file)
+                printf("Input: %s, one document per line, read in %.3f ms\n\n", file, slowest * 1e3);
+            else
+                printf("Input: %lld synthetic documents x %d words, vocabulary %d, generated in %.3f ms\n\n",
+                       docs, words, vocabulary, slowest * 1e3);
+        }
+    }
+
+    if (run_words)
+        word_count(documents, combine, rank);
+    if (run_histogram)
+        histogram(values, seed, combine, rank, size);
+    if (run_index)
+        inverted_index(documents, combine, rank);
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,589 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <mpi.h>
+
+#include "gemm_kernels.h"
+#include "splitmix64.h"
+
+/*
+    Distributed dense matrix multiplication C = A * B (MPI + threads + SIMD).
+
+    A is M x K, B is K x N, both row-major and block-distributed over a 2D
+    process grid (MPI_Dims_create + MPI_Cart_create, pr rows x pc columns):
+    process (i, j) owns the C block of row block i and column block j, the A
+    block of row block i and K block j (K split pc ways), and the B block of
+    K block i (K split pr ways) and column block j. Blocks differ by at most
+    one row or column. Entries are a hash of their global index, so every
+    process builds its own blocks and the result can be checked anywhere.
+
+    SUMMA (-a summa, any grid): K is walked in panels of at most -b columns,
+    cut so no panel straddles an A or B block boundary. For every panel the
+    owning process column broadcasts its A columns along the process row, the
+    owning process row broadcasts its B rows down the process column, and
+    every process adds the panel product to its C block.
+
+    Cannon (-a cannon, square grid p x p): after skewing A left by the row
+    index and B up by the column index, every process holds matching K blocks;
+    p times it multiplies them and shifts A one process left and B one
+    process up (periodic grid).
+
+    Overlap: both algorithms double-buffer their operands. Thread 0 posts the
+    MPI_Ibcast (SUMMA) or MPI_Isend/Irecv (Cannon) of step s + 1 before the
+    update of step s and polls them with MPI_Testall between A blocks of its
+    local GEMM, so the transfer progresses while the cores compute. -s posts
+    them only after the update (no overlap) for comparison.
+
+    Local update: gemmBlocked() from gemm_kernels.h (packed, 6 x 8 register
+    tiles, ISPC micro-kernel with -DUSE_ISPC) or the naive triple loop
+    (-k naive). Threads split the columns of the C block in multiples of the
+    register tile; only thread 0 calls MPI.
+
+    The result is checked on -c sampled entries per process against the exact
+    dot product of the generated A row and B column. GFLOP/s is reported in
+    total, per node (processes sharing memory, MPI_Comm_split_type) and per
+    process. -B times the local kernels instead: naive, blocked on one thread
+    and blocked on -t threads, on rank 0 alone.
+
+    ispc -O2 --target=avx2-i32x8 gemm.ispc -o gemm_ispc.o -h gemm_ispc.h
+    mpicc -O3 -march=native -DUSE_ISPC matmul.c gemm_ispc.o -o matmul -lpthread -lm
+    mpirun -np 4 ./matmul [-n m[,n[,k]]] [-a summa|cannon] [-k blocked|naive] [-b panel] [-t threads]
+                          [-s] [-c samples] [-B]
+*/
+
+#define DEFAULT_SIZE 2048
+#define DEFAULT_PANEL 256
+#define DEFAULT_SAMPLES 64
+#define MAX_THREADS 256
+#define SALT_A 0x243F6A8885A308D3ULL
+#define SALT_B 0x13198A2E03707344ULL
+
+typedef enum { ALG_SUMMA, ALG_CANNON } algorithm_t;
+typedef enum { KERNEL_BLOCKED, KERNEL_NAIVE } kernel_t;
+
+typedef struct {
+    int m, n, k;
+    algorithm_t algorithm;
+    kernel_t kernel;
+    int panel;          // SUMMA panel width
+    int threads;
+    int overlap;        // post step s + 1 before computing step s
+    int samples;        // checked entries per process
+} matmul_config;
+
+typedef struct {
+    int k0, width;      // global columns of A (rows of B) in the panel
+    int a_root;         // process column owning them in A
+    int b_root;         // process row owning them in B
+} summa_step;
+
+typedef struct {
+    matmul_config cfg;
+    MPI_Comm grid, row_comm, col_comm;
+    int rank, size;
+    int dims[2], coords[2];     // process rows and columns
+    int m0, mloc, n0, nloc;     // owned rows and columns of C
+    int ka0, kaloc;             // owned columns of A
+    int kb0, kbloc;             // owned rows of B
+    double* A;
+    double* B;
+    double* C;
+    double* a_buf[2];
+    double* b_buf[2];
+
+    // operands of the steps in flight, slot s & 1 holds step s
+    double* a_op[2];            // mloc x width, leading dimension width
+    double* b_op[2];            // width x nloc, leading dimension nloc
+    int width[2];
+    summa_step* steps;
+    int num_steps;
+    MPI_Request requests[4];
+    int num_requests;
+
+    // thread coordination
+    pthread_barrier_t barrier;
+    gemm_workspace ws[MAX_THREADS];
+    double compute_time;        // thread 0 time in local updates
+    double wait_time;           // thread 0 time waiting for operands after its update
+} matmul;
+
+typedef struct {
+    matmul* mm;
+    int tid;
+} matmul_thread;
+
+// Function to get the first index and count of block `coord` out of `dims` over n
+static void blockRange(int n, int dims, int coord, int* start, int* count) {
+    int base = n / dims, rem = n % dims;
+    *start = coord * base + (coord < rem ? coord : rem);
+    *count = base + (coord < rem ? 1 : 0);
+}
+
+// Function to find the block out of `dims` over n that holds index
+static int blockOwner(int n, int dims, int index) {
+    for (int b = 0; b < dims; b++) {
+        int start, count;
+        blockRange(n, dims, b, &start, &count);
+        if (index < start + count)
+            return b;
+    }
+    return dims - 1;
+}
+
+// Function to get the entry at (row, col) of a generated matrix with ld columns, in [-1, 1)
+static inline double entry(uint64_t salt, int row, int col, int ld) {
+    uint64_t z = mix64(salt ^ ((uint64_t)row * (uint64_t)ld + (uint64_t)col));
+    return (double)(z >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+static double* allocDoubles(size_t n) {
+    return (double*)malloc(sizeof(double) * (n > 0 ? n : 1));
+}
+
+// Function to cut K into panels that stay inside one A block and one B block
+static void buildSteps(matmul* mm) {
+    int K = mm->cfg.k;
+    mm->steps = (summa_step*)malloc(sizeof(summa_step) * (K > 0 ? K : 1));
+    mm->num_steps = 0;
+    for (int k0 = 0; k0 < K;) {
+        summa_step* st = &mm->steps[mm->num_steps++];
+        int a_start, a_count, b_start, b_count;
+        st->k0 = k0;
+        st->a_root = blockOwner(K, mm->dims[1], k0);
+        st->b_root = blockOwner(K, mm->dims[0], k0);
+        blockRange(K, mm->dims[1], st->a_root, &a_start, &a_count);
+        blockRange(K, mm->dims[0], st->b_root, &b_start, &b_count);
+        int end = k0 + mm->cfg.panel;
+        if (end > a_start + a_count) end = a_start + a_count;
+        if (end > b_start + b_count) end = b_start + b_count;
+        st->width = end - k0;
+        k0 = end;
+    }
+}
+
+// Function to post the broadcasts of SUMMA step s into slot s & 1
+static void startSumma(matmul* mm, int s) {
+    const summa_step* st = &mm->steps[s];
+    int slot = s & 1, w = st->width;
+    mm->width[slot] = w;
+    mm->a_op[slot] = mm->a_buf[slot];
+    if (mm->coords[1] == st->a_root) {
+        const double* src = mm->A + (st->k0 - mm->ka0);
+        for (int i = 0; i < mm->mloc; i++)
+            memcpy(mm->a_op[slot] + (size_t)i * w, src + (size_t)i * mm->kaloc, sizeof(double) * w);
+    }
+    // B rows are contiguous, the root broadcasts straight from its block
+    if (mm->coords[0] == st->b_root)
+        mm->b_op[slot] = mm->B + (size_t)(st->k0 - mm->kb0) * mm->nloc;
+    else
+        mm->b_op[slot] = mm->b_buf[slot];
+    MPI_Ibcast(mm->a_op[slot], mm->mloc * w, MPI_DOUBLE, st->a_root, mm->row_comm,
+               &mm->requests[mm->num_requests++]);
+    MPI_Ibcast(mm->b_op[slot], w * mm->nloc, MPI_DOUBLE, st->b_root, mm->col_comm,
+               &mm->requests[mm->num_requests++]);
+}
+
+// Function to get the process in the grid at (row, col), wrapping around
+static int gridRank(const matmul* mm, int row, int col) {
+    int coords[2] = { ((row % mm->dims[0]) + mm->dims[0]) % mm->dims[0],
+                      ((col % mm->dims[1]) + mm->dims[1]) % mm->dims[1] };
+    int rank;
+    MPI_Cart_rank(mm->grid, coords, &rank);
+    return rank;
+}
+
+// Function to get the K block Cannon multiplies at step s
+static int cannonBlock(const matmul* mm, int s) {
+    return (mm->coords[0] + mm->coords[1] + s) % mm->dims[0];
+}
+
+// Function to skew A left by the row index and B up by the column index into slot 0
+static void skewCannon(matmul* mm) {
+    int i = mm->coords[0], j = mm->coords[1], q = cannonBlock(mm, 0), k0, kq;
+    blockRange(mm->cfg.k, mm->dims[0], q, &k0, &kq);
+    MPI_Sendrecv(mm->A, mm->mloc * mm->kaloc, MPI_DOUBLE, gridRank(mm, i, j - i), 0,
+                 mm->a_buf[0], mm->mloc * kq, MPI_DOUBLE, gridRank(mm, i, j + i), 0,
+                 mm->grid, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(mm->B, mm->kbloc * mm->nloc, MPI_DOUBLE, gridRank(mm, i - j, j), 1,
+                 mm->b_buf[0], kq * mm->nloc, MPI_DOUBLE, gridRank(mm, i + j, j), 1,
+                 mm->grid, MPI_STATUS_IGNORE);
+    mm->a_op[0] = mm->a_buf[0];
+    mm->b_op[0] = mm->b_buf[0];
+    mm->width[0] = kq;
+}
+
+// Function to post the shifts that bring Cannon step s into slot s & 1
+static void startCannon(matmul* mm, int s) {
+    int slot = s & 1, prev = slot ^ 1, i = mm->coords[0], j = mm->coords[1], k0, kq;
+    blockRange(mm->cfg.k, mm->dims[0], cannonBlock(mm, s), &k0, &kq);
+    mm->a_op[slot] = mm->a_buf[slot];
+    mm->b_op[slot] = mm->b_buf[slot];
+    mm->width[slot] = kq;
+    MPI_Irecv(mm->a_op[slot], mm->mloc * kq, MPI_DOUBLE, gridRank(mm, i, j + 1), 0, mm->grid,
+              &mm->requests[mm->num_requests++]);
+    MPI_Irecv(mm->b_op[slot], kq * mm->nloc, MPI_DOUBLE, gridRank(mm, i + 1, j), 1, mm->grid,
+              &mm->requests[mm->num_requests++]);
+    MPI_Isend(mm->a_op[prev], mm->mloc * mm->width[prev], MPI_DOUBLE, gridRank(mm, i, j - 1), 0, mm->grid,
+              &mm->requests[mm->num_requests++]);
+    MPI_Isend(mm->b_op[prev], mm->width[prev] * mm->nloc, MPI_DOUBLE, gridRank(mm, i - 1, j), 1, mm->grid,
+              &mm->requests[mm->num_requests++]);
+}
+
+static void startStep(matmul* mm, int s) {
+    if (mm->cfg.algorithm == ALG_CANNON)
+        startCannon(mm, s);
+    else
+        startSumma(mm, s);
+}
+
+static void waitOperands(matmul* mm) {
+    MPI_Waitall(mm->num_requests, mm->requests, MPI_STATUSES_IGNORE);
+    mm->num_requests = 0;
+}
+
+// Progress callback of thread 0's GEMM: lets the posted transfers advance
+static void pollOperands(void* arg) {
+    matmul* mm = (matmul*)arg;
+    int done;
+    if (mm->num_requests > 0)
+        MPI_Testall(mm->num_requests, mm->requests, &done, MPI_STATUSES_IGNORE);
+}
+
+// Function to add the operands in `slot` to this thread's columns of C
+static void localUpdate(matmul* mm, int tid, int slot) {
+    int slivers = (mm->nloc + GEMM_NR - 1) / GEMM_NR, first, count;
+    blockRange(slivers, mm->cfg.threads, tid, &first, &count);
+    int j0 = first * GEMM_NR, j1 = (first + count) * GEMM_NR;
+    if (j1 > mm->nloc) j1 = mm->nloc;
+    if (j0 >= j1 || mm->mloc == 0 || mm->width[slot] == 0)
+        return;
+    int w = mm->width[slot];
+    if (mm->cfg.kernel == KERNEL_NAIVE)
+        gemmNaive(mm->mloc, j1 - j0, w, mm->a_op[slot], w, mm->b_op[slot] + j0, mm->nloc, mm->C + j0, mm->nloc);
+    else
+        gemmBlocked(mm->mloc, j1 - j0, w, mm->a_op[slot], w, mm->b_op[slot] + j0, mm->nloc, mm->C + j0, mm->nloc,
+                    &mm->ws[tid]);
+}
+
+static void* matmulThread(void* arg) {
+    matmul_thread* mt = (matmul_thread*)arg;
+    matmul* mm = mt->mm;
+    int tid = mt->tid;
+    int steps = mm->cfg.algorithm == ALG_CANNON ? mm->dims[0] : mm->num_steps;
+
+    if (tid == 0) {
+        if (mm->cfg.algorithm == ALG_CANNON)
+            skewCannon(mm);
+        else
+            startSumma(mm, 0);
+        waitOperands(mm);
+    }
+    pthread_barrier_wait(&mm->barrier);
+
+    for (int s = 0; s < steps; s++) {
+        int slot = s & 1;
+        double start = 0;
+        if (tid == 0) {
+            if (mm->cfg.overlap && s + 1 < steps)
+                startStep(mm, s + 1);
+            start = MPI_Wtime();
+        }
+        localUpdate(mm, tid, slot);
+        if (tid == 0) {
+            double computed = MPI_Wtime();
+            mm->compute_time += computed - start;
+            if (!mm->cfg.overlap && s + 1 < steps)
+                startStep(mm, s + 1);
+            waitOperands(mm);
+            mm->wait_time += MPI_Wtime() - computed;
+        }
+        // slot s & 1 is reused by step s + 2, which thread 0 posts after this barrier
+        pthread_barrier_wait(&mm->barrier);
+    }
+    return NULL;
+}
+
+// Function to set up the grid, the blocks and the buffers; returns 0 if the grid does not fit the algorithm
+static int createMatmul(matmul* mm, const matmul_config* cfg, MPI_Comm comm) {
+    memset(mm, 0, sizeof(*mm));
+    mm->cfg = *cfg;
+    MPI_Comm_size(comm, &mm->size);
+    MPI_Dims_create(mm->size, 2, mm->dims);
+    if (cfg->algorithm == ALG_CANNON && mm->dims[0] != mm->dims[1])
+        return 0;
+    int periods[2] = { 1, 1 }, row_keep[2] = { 0, 1 }, col_keep[2] = { 1, 0 };
+    MPI_Cart_create(comm, 2, mm->dims, periods, 1, &mm->grid);
+    MPI_Comm_rank(mm->grid, &mm->rank);
+    MPI_Cart_coords(mm->grid, mm->rank, 2, mm->coords);
+    MPI_Cart_sub(mm->grid, row_keep, &mm->row_comm);
+    MPI_Cart_sub(mm->grid, col_keep, &mm->col_comm);
+
+    blockRange(cfg->m, mm->dims[0], mm->coords[0], &mm->m0, &mm->mloc);
+    blockRange(cfg->n, mm->dims[1], mm->coords[1], &mm->n0, &mm->nloc);
+    blockRange(cfg->k, mm->dims[1], mm->coords[1], &mm->ka0, &mm->kaloc);
+    blockRange(cfg->k, mm->dims[0], mm->coords[0], &mm->kb0, &mm->kbloc);
+
+    mm->A = allocDoubles((size_t)mm->mloc * mm->kaloc);
+    mm->B = allocDoubles((size_t)mm->kbloc * mm->nloc);
+    mm->C = allocDoubles((size_t)mm->mloc * mm->nloc);
+    int kmax = cfg->algorithm == ALG_CANNON ? (cfg->k + mm->dims[0] - 1) / mm->dims[0] : cfg->panel;
+    for (int b = 0; b < 2; b++) {
+        mm->a_buf[b] = allocDoubles((size_t)mm->mloc * kmax);
+        mm->b_buf[b] = allocDoubles((size_t)kmax * mm->nloc);
+    }
+    if (mm->A == NULL || mm->B == NULL || mm->C == NULL || mm->a_buf[0] == NULL || mm->a_buf[1] == NULL ||
+        mm->b_buf[0] == NULL || mm->b_buf[1] == NULL) {
+        fprintf(stderr, "Process %d: failed to allocate the matrix blocks\n", mm->rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    for (int i = 0; i < mm->mloc; i++)
+        for (int p = 0; p < mm->kaloc; p++)
+            mm->A[(size_t)i * mm->kaloc + p] = entry(SALT_A, mm->m0 + i, mm->ka0 + p, cfg->k);
+    for (int p = 0; p < mm->kbloc; p++)
+        for (int j = 0; j < mm->nloc; j++)
+            mm->B[(size_t)p * mm->nloc + j] = entry(SALT_B, mm->kb0 + p, mm->n0 + j, cfg->n);
+    memset(mm->C, 0, sizeof(double) * mm->mloc * mm->nloc);
+
+    if (cfg->algorithm == ALG_SUMMA)
+        buildSteps(mm);
+    for (int t = 0; t < cfg->threads; t++) {
+        if (!gemmWorkspaceInit(&mm->ws[t])) {
+            fprintf(stderr, "Process %d: failed to allocate the GEMM workspace\n", mm->rank);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    if (cfg->overlap) {
+        mm->ws[0].progress = pollOperands;
+        mm->ws[0].progress_arg = mm;
+    }
+    pthread_barrier_init(&mm->barrier, NULL, cfg->threads);
+    return 1;
+}
+
+static void destroyMatmul(matmul* mm) {
+    for (int t = 0; t < mm->cfg.threads; t++)
+        gemmWorkspaceFree(&mm->ws[t]);
+    for (int b = 0; b < 2; b++) {
+        free(mm->a_buf[b]);
+        free(mm->b_buf[b]);
+    }
+    free(mm->A);
+    free(mm->B);
+    free(mm->C);
+    free(mm->steps);
+    pthread_barrier_destroy(&mm->barrier);
+    MPI_Comm_free(&mm->row_comm);
+    MPI_Comm_free(&mm->col_comm);
+    MPI_Comm_free(&mm->grid);
+}
+
+// Function to run the multiplication on all threads; returns the slowest process's time
+static double runMatmul(matmul* mm) {
+    pthread_t threads[MAX_THREADS];
+    matmul_thread args[MAX_THREADS];
+    MPI_Barrier(mm->grid);
+    double start = MPI_Wtime();
+    for (int t = 0; t < mm->cfg.threads; t++) {
+        args[t].mm = mm;
+        args[t].tid = t;
+        if (t > 0 && pthread_create(&threads[t], NULL, matmulThread, &args[t]) != 0) {
+            fprintf(stderr, "Process %d: failed to create thread %d\n", mm->rank, t);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    matmulThread(&args[0]);
+    for (int t = 1; t < mm->cfg.threads; t++)
+        pthread_join(threads[t], NULL);
+    double elapsed = MPI_Wtime() - start, slowest;
+    MPI_Allreduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, mm->grid);
+    return slowest;
+}
+
+// Function to compare sampled C entries with the exact dot products; returns the largest error
+static double checkSamples(const matmul* mm) {
+    double max_error = 0;
+    if (mm->mloc > 0 && mm->nloc > 0) {
+        for (int s = 0; s < mm->cfg.samples; s++) {
+            uint64_t z = mix64(((uint64_t)mm->rank << 32) | (uint64_t)s);
+            int i = (int)((z & 0xffffffffULL) % (uint64_t)mm->mloc);
+            int j = (int)((z >> 32) % (uint64_t)mm->nloc);
+            long double exact = 0;
+            for (int p = 0; p < mm->cfg.k; p++)
+                exact += (long double)entry(SALT_A, mm->m0 + i, p, mm->cfg.k) *
+                         entry(SALT_B, p, mm->n0 + j, mm->cfg.n);
+            double error = fabs((double)((long double)mm->C[(size_t)i * mm->nloc + j] - exact));
+            if (error > max_error)
+                max_error = error;
+        }
+    }
+    double global;
+    MPI_Allreduce(&max_error, &global, 1, MPI_DOUBLE, MPI_MAX, mm->grid);
+    return global;
+}
+
+// Function to count the nodes (shared-memory domains) spanned by comm
+static int nodeCount(MPI_Comm comm) {
+    MPI_Comm node;
+    int node_rank, leader, nodes;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node);
+    MPI_Comm_rank(node, &node_rank);
+    leader = node_rank == 0;
+    MPI_Allreduce(&leader, &nodes, 1, MPI_INT, MPI_SUM, comm);
+    MPI_Comm_free(&node);
+    return nodes;
+}
+
+static double gflops(const matmul_config* cfg, double seconds) {
+    return 2.0 * cfg->m * cfg->n * cfg->k / seconds / 1e9;
+}
+
+static void multiplyOnce(const matmul_config* cfg, int world_rank) {
+    matmul mm;
+    if (!createMatmul(&mm, cfg, MPI_COMM_WORLD)) {
+        if (world_rank == 0)
+            fprintf(stderr, "Cannon needs a square process grid, %d processes give %d x %d\n",
+                    mm.size, mm.dims[0], mm.dims[1]);
+        return;
+    }
+    double elapsed = runMatmul(&mm);
+    double max_error = checkSamples(&mm);
+    int nodes = nodeCount(mm.grid);
+    double times[2] = { mm.compute_time, mm.wait_time }, slowest[2];
+    MPI_Reduce(times, slowest, 2, MPI_DOUBLE, MPI_MAX, 0, mm.grid);
+    double tolerance = 1e-14 * cfg->k;
+
+    if (mm.rank == 0) {
+        double total = gflops(cfg, elapsed);
+        printf("%s %d x %d x %d on %d x %d processes (%d node%s), %d thread%s each, %s kernel",
+               cfg->algorithm == ALG_CANNON ? "Cannon" : "SUMMA", cfg->m, cfg->n, cfg->k, mm.dims[0], mm.dims[1],
+               nodes, nodes == 1 ? "" : "s", cfg->threads, cfg->threads == 1 ? "" : "s",
+               cfg->kernel == KERNEL_NAIVE ? "naive" : "blocked");
+        if (cfg->algorithm == ALG_SUMMA)
+            printf(", %d panels of up to %d", mm.num_steps, cfg->panel);
+        printf(", overlap %s\n", cfg->overlap ? "on" : "off");
+        printf("Time: %.3f s, %.2f GFLOP/s total, %.2f per node, %.2f per process\n", elapsed, total,
+               total / nodes, total / mm.size);
+        printf("Slowest process: %.3f s in local updates, %.3f s waiting for operands\n", slowest[0], slowest[1]);
+        printf("Check: %d sampled entries per process, max error %.3e (tolerance %.1e) %s\n", cfg->samples,
+               max_error, tolerance, max_error <= tolerance ? "OK" : "FAILED");
+    }
+    destroyMatmul(&mm);
+}
+
+// Function to time the local kernels on rank 0: naive, blocked, blocked on all threads
+static void benchmarkKernels(const matmul_config* base, int world_rank) {
+    if (world_rank != 0)
+        return;
+    const struct {
+        const char* name;
+        kernel_t kernel;
+        int threads;
+    } runs[] = {
+        { "naive triple loop", KERNEL_NAIVE, 1 },
+        { "blocked, 1 thread", KERNEL_BLOCKED, 1 },
+        { "blocked, all threads", KERNEL_BLOCKED, base->threads },
+    };
+    printf("Local GEMM %d x %d x %d\n", base->m, base->n, base->k);
+    printf("%-24s %8s %10s %10s\n", "kernel", "threads", "time s", "GFLOP/s");
+    double naive_time = 0;
+    for (int r = 0; r < 3; r++) {
+        if (r == 2 && base->threads == 1)
+            break;
+        matmul_config cfg = *base;
+        cfg.algorithm = ALG_SUMMA;
+        cfg.kernel = runs[r].kernel;
+        cfg.threads = runs[r].threads;
+        cfg.samples = 0;
+        matmul mm;
+        createMatmul(&mm, &cfg, MPI_COMM_SELF);
+        double elapsed = runMatmul(&mm);
+        if (r == 0)
+            naive_time = elapsed;
+        printf("%-24s %8d %10.3f %10.2f", runs[r].name, cfg.threads, elapsed, gflops(&cfg, elapsed));
+        if (r > 0)
+            printf("   %.1fx naive", naive_time / elapsed);
+        printf("\n");
+        destroyMatmul(&mm);
+    }
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [options]\n", prog);
+    fprintf(stderr, "  -n m[,n[,k]]        C is m x n, A m x k, B k x n, default %d^3\n", DEFAULT_SIZE);
+    fprintf(stderr, "  -a summa|cannon     algorithm, Cannon needs a square process count, default summa\n");
+    fprintf(stderr, "  -k blocked|naive    local GEMM kernel, default blocked\n");
+    fprintf(stderr, "  -b panel            SUMMA panel width, default %d\n", DEFAULT_PANEL);
+    fprintf(stderr, "  -t threads          threads per process, default 1\n");
+    fprintf(stderr, "  -s                  start the next transfer after the update (no overlap)\n");
+    fprintf(stderr, "  -c samples          checked entries of C per process, default %d\n", DEFAULT_SAMPLES);
+    fprintf(stderr, "  -B                  benchmark the local kernels on rank 0\n");
+}
+
+int main(int argc, char* argv[]) {
+    int provided, world_rank;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+    matmul_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.m = cfg.n = cfg.k = DEFAULT_SIZE;
+    cfg.algorithm = ALG_SUMMA;
+    cfg.kernel = KERNEL_BLOCKED;
+    cfg.panel = DEFAULT_PANEL;
+    cfg.threads = 1;
+    cfg.overlap = 1;
+    cfg.samples = DEFAULT_SAMPLES;
+    int benchmark = 0, bad = 0;
+
+    // Parse command line options (every rank parses the same argv)
+    int opt;
+    while ((opt = getopt(argc, argv, "n:a:k:b:t:sc:B")) != -1) {
+        switch (opt) {
+        case 'n': {
+            int sizes[3];
+            int count = sscanf(optarg, "%d,%d,%d", &sizes[0], &sizes[1], &sizes[2]);
+            if (count < 1) { bad = 1; break; }
+            cfg.m = sizes[0];
+            cfg.n = count > 1 ? sizes[1] : sizes[0];
+            cfg.k = count > 2 ? sizes[2] : cfg.n;
+            break;
+        }
+        case 'a':
+            if (strcmp(optarg, "summa") == 0) cfg.algorithm = ALG_SUMMA;
+            else if (strcmp(optarg, "cannon") == 0) cfg.algorithm = ALG_CANNON;
+            else bad = 1;
+            break;
+        case 'k':
+            if (strcmp(optarg, "blocked") == 0) cfg.kernel = KERNEL_BLOCKED;
+            else if (strcmp(optarg, "naive") == 0) cfg.kernel = KERNEL_NAIVE;
+            else bad = 1;
+            break;
+        case 'b': cfg.panel = atoi(optarg); break;
+        case 't': cfg.threads = atoi(optarg); break;
+        case 's': cfg.overlap = 0; break;
+        case 'c': cfg.samples = atoi(optarg); break;
+        case 'B': benchmark = 1; break;
+        default: bad = 1;
+        }
+    }
+    if (bad || cfg.m < 1 || cfg.n < 1 || cfg.k < 1 || cfg.panel < 1 || cfg.threads < 1 ||
+        cfg.threads > MAX_THREADS || cfg.samples < 0) {
+        if (world_rank == 0) usage(argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+    if (provided < MPI_THREAD_FUNNELED && cfg.threads > 1 && world_rank == 0)
+        fprintf(stderr, "Warning: MPI library does not provide MPI_THREAD_FUNNELED\n");
+
+    if (benchmark)
+        benchmarkKernels(&cfg, world_rank);
+    else
+        multiplyOnce(&cfg, world_rank);
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,353 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <mpi.h>
+
+#include "philox.h"
+
+#ifdef USE_ISPC
+#include "monte_carlo_ispc.h"
+#endif
+
+/*
+    Monte Carlo engine: MPI ranks x threads x SIMD lanes.
+
+    Experiments:
+        pi          fraction of uniform points of the unit square inside the quarter circle
+        option      European call under geometric Brownian motion (checked against Black-Scholes)
+        integrate   prod_j (pi / 2) sin(pi x_j) over [0, 1]^d, exact value 1
+
+    Random numbers: sample i of an experiment draws from Philox4x32-10 with the
+    counter (i, draw, experiment) and the seed as key (philox.h). The samples
+    are cut into blocks of BLOCK; ranks get contiguous block ranges, threads
+    sub-ranges, SIMD lanes single samples. No generator state is shared or
+    split, so sample i gets the same numbers for any -np, -t or kernel, and
+    the estimates only differ by the order of the floating-point sums.
+
+    Estimators: every block returns the sum and sum of squares of its samples,
+    which become (count, mean, M2) and are merged with Chan's pairwise update,
+    across threads and then across ranks with a user MPI_Op, so the variance
+    stays accurate even for 1e12 samples.
+
+    ispc -O2 monte_carlo.ispc -o monte_carlo_ispc.o -h monte_carlo_ispc.h
+    mpicc -O2 -DUSE_ISPC monte_carlo.c monte_carlo_ispc.o -o monte_carlo -lpthread -lm
+    mpirun -np 4 ./monte_carlo [-e pi|option|integrate|all] [-n samples] [-t threads] [-s seed]
+                               [-d dims] [-a] [-k scalar|ispc] [-B]
+*/
+
+#define BLOCK 4096
+#define DEFAULT_SAMPLES 100000000
+#define DEFAULT_SEED 2024
+#define DEFAULT_DIMS 6
+#define MAX_THREADS 256
+
+// Option parameters: at the money, one year
+#define SPOT 100.0
+#define STRIKE 100.0
+#define RATE 0.05
+#define VOLATILITY 0.2
+#define MATURITY 1.0
+
+typedef enum { EXP_PI = 1, EXP_OPTION = 2, EXP_INTEGRATE = 3 } experiment_t;
+
+typedef struct {
+    double n, mean, m2;     // count, mean, sum of squared deviations
+} mc_stats;
+
+typedef struct {
+    experiment_t experiment;
+    uint32_t key[2];
+    int dims;
+    int antithetic;
+    int use_ispc;
+} mc_config;
+
+typedef struct {
+    const mc_config* cfg;
+    long long first_block, last_block;  // [first, last) of the whole run's blocks
+    long long samples;                  // total samples (the last block may be partial)
+    mc_stats stats;
+} mc_thread;
+
+static const char* experimentName(experiment_t e) {
+    return e == EXP_PI ? "pi" : e == EXP_OPTION ? "option" : "integrate";
+}
+
+// Function to merge b into a (Chan et al. pairwise update)
+static void statsMerge(mc_stats* a, const mc_stats* b) {
+    if (b->n == 0)
+        return;
+    if (a->n == 0) {
+        *a = *b;
+        return;
+    }
+    double n = a->n + b->n;
+    double delta = b->mean - a->mean;
+    a->m2 += b->m2 + delta * delta * a->n * b->n / n;
+    a->mean += delta * b->n / n;
+    a->n = n;
+}
+
+static void statsReduce(void* in, void* inout, int* len, MPI_Datatype* type) {
+    (void)type;
+    for (int i = 0; i < *len; i++)
+        statsMerge((mc_stats*)inout + i, (const mc_stats*)in + i);
+}
+
+// ---------------------------------------------------------------- scalar sample blocks
+
+static inline void draw(const mc_config* cfg, long long index, uint32_t draw_index, uint32_t out[4]) {
+    uint32_t counter[4] = { (uint32_t)index, (uint32_t)((uint64_t)index >> 32), draw_index,
+                            (uint32_t)cfg->experiment };
+    philox4x32(counter, cfg->key, out);
+}
+
+// Function to evaluate samples [first, first + count) with the C loops; same math as monte_carlo.ispc
+static void blockScalar(const mc_config* cfg, long long first, int count, double result[2]) {
+    double sum = 0, sum_sq = 0;
+    uint32_t r[4];
+    if (cfg->experiment == EXP_PI) {
+        for (int k = 0; k < count; k++) {
+            draw(cfg, first + k, 0, r);
+            double x = philoxUniform(r[0], r[1]), y = philoxUniform(r[2], r[3]);
+            sum += x * x + y * y <= 1.0;
+        }
+        sum_sq = sum;
+    } else if (cfg->experiment == EXP_OPTION) {
+        double drift = (RATE - 0.5 * VOLATILITY * VOLATILITY) * MATURITY;
+        double diffusion = VOLATILITY * sqrt(MATURITY);
+        double discount = exp(-RATE * MATURITY);
+        for (int k = 0; k < count; k++) {
+            draw(cfg, first + k, 0, r);
+            double u1 = philoxUniform(r[0], r[1]), u2 = philoxUniform(r[2], r[3]);
+            double z = sqrt(-2.0 * log(u1)) * cos(2 * M_PI * u2);
+            double payoff = discount * fmax(SPOT * exp(drift + diffusion * z) - STRIKE, 0.0);
+            if (cfg->antithetic) {
+                double mirror = discount * fmax(SPOT * exp(drift - diffusion * z) - STRIKE, 0.0);
+                payoff = 0.5 * (payoff + mirror);
+            }
+            sum += payoff;
+            sum_sq += payoff * payoff;
+        }
+    } else {
+        for (int k = 0; k < count; k++) {
+            double f = 1.0;
+            for (int j = 0; j < cfg->dims; j += 2) {
+                draw(cfg, first + k, j / 2, r);
+                f *= M_PI / 2 * sin(M_PI * philoxUniform(r[0], r[1]));
+                if (j + 1 < cfg->dims)
+                    f *= M_PI / 2 * sin(M_PI * philoxUniform(r[2], r[3]));
+            }
+            sum += f;
+            sum_sq += f * f;
+        }
+    }
+    result[0] = sum;
+    result[1] = sum_sq;
+}
+
+static void evaluateBlock(const mc_config* cfg, long long first, int count, double result[2]) {
+#ifdef USE_ISPC
+    if (cfg->use_ispc) {
+        if (cfg->experiment == EXP_PI)
+            mc_pi_block(cfg->key[0], cfg->key[1], first, count, result);
+        else if (cfg->experiment == EXP_OPTION)
+            mc_option_block(cfg->key[0], cfg->key[1], first, count, SPOT, STRIKE, RATE, VOLATILITY, MATURITY,
+                            cfg->antithetic, result);
+        else
+            mc_integrate_block(cfg->key[0], cfg->key[1], first, count, cfg->dims, result);
+        return;
+    }
+#endif
+    blockScalar(cfg, first, count, result);
+}
+
+static void* runThread(void* arg) {
+    mc_thread* t = (mc_thread*)arg;
+    memset(&t->stats, 0, sizeof(t->stats));
+    for (long long b = t->first_block; b < t->last_block; b++) {
+        long long first = b * BLOCK;
+        int count = (int)(t->samples - first < BLOCK ? t->samples - first : BLOCK);
+        double result[2];
+        evaluateBlock(t->cfg, first, count, result);
+        mc_stats block = { (double)count, result[0] / count, result[1] - result[0] * result[0] / count };
+        statsMerge(&t->stats, &block);
+    }
+    return NULL;
+}
+
+// Function to run `samples` samples over all ranks and threads; returns the global stats on every rank
+static mc_stats runExperiment(const mc_config* cfg, long long samples, int num_threads, MPI_Op op,
+                              MPI_Datatype type, double* elapsed) {
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    long long blocks = (samples + BLOCK - 1) / BLOCK;
+    long long my_first = blocks * rank / size, my_last = blocks * (rank + 1) / size;
+
+    pthread_t threads[MAX_THREADS];
+    mc_thread jobs[MAX_THREADS];
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start = MPI_Wtime();
+    for (int t = 0; t < num_threads; t++) {
+        jobs[t].cfg = cfg;
+        jobs[t].samples = samples;
+        jobs[t].first_block = my_first + (my_last - my_first) * t / num_threads;
+        jobs[t].last_block = my_first + (my_last - my_first) * (t + 1) / num_threads;
+        if (t > 0 && pthread_create(&threads[t], NULL, runThread, &jobs[t]) != 0) {
+            fprintf(stderr, "Process %d: failed to create thread %d\n", rank, t);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    runThread(&jobs[0]);
+    mc_stats local = jobs[0].stats;
+    for (int t = 1; t < num_threads; t++) {
+        pthread_join(threads[t], NULL);
+        statsMerge(&local, &jobs[t].stats);
+    }
+    mc_stats global;
+    MPI_Allreduce(&local, &global, 1, type, op, MPI_COMM_WORLD);
+    *elapsed = MPI_Wtime() - start;
+    return global;
+}
+
+// Function to get the Black-Scholes price of the European call
+static double blackScholesCall(void) {
+    double d1 = (log(SPOT / STRIKE) + (RATE + 0.5 * VOLATILITY * VOLATILITY) * MATURITY) /
+                (VOLATILITY * sqrt(MATURITY));
+    double d2 = d1 - VOLATILITY * sqrt(MATURITY);
+    return SPOT * 0.5 * erfc(-d1 / sqrt(2.0)) - STRIKE * exp(-RATE * MATURITY) * 0.5 * erfc(-d2 / sqrt(2.0));
+}
+
+// Function to print an estimate with its standard error and distance to the exact value
+static void report(const mc_config* cfg, const mc_stats* s, double elapsed, int num_threads) {
+    double scale = cfg->experiment == EXP_PI ? 4.0 : 1.0;
+    double exact = cfg->experiment == EXP_PI ? M_PI : cfg->experiment == EXP_OPTION ? blackScholesCall() : 1.0;
+    double estimate = scale * s->mean;
+    double std_error = scale * sqrt(s->m2 / (s->n - 1) / s->n);
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    printf("%-10s %.0f samples", experimentName(cfg->experiment), s->n);
+    if (cfg->experiment == EXP_INTEGRATE)
+        printf(" (%d dims)", cfg->dims);
+    if (cfg->experiment == EXP_OPTION && cfg->antithetic)
+        printf(" (antithetic)");
+    printf("\n  estimate %.8f +- %.2e, exact %.8f, off by %.2f standard errors\n", estimate, std_error, exact,
+           std_error > 0 ? fabs(estimate - exact) / std_error : 0.0);
+    printf("  %.3f s, %.1f Msamples/s (%.1f per thread), %s kernel\n", elapsed, s->n / elapsed / 1e6,
+           s->n / elapsed / 1e6 / (size * num_threads), cfg->use_ispc ? "ispc" : "scalar");
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-e pi|option|integrate|all] [-n samples] [-t threads] [-s seed] [-d dims] [-a]\n",
+            prog);
+    fprintf(stderr, "          [-k scalar|ispc] [-B]\n");
+    fprintf(stderr, "  -e  experiment, default all\n");
+    fprintf(stderr, "  -n  samples in total (e.g. 1e10), default %d\n", DEFAULT_SAMPLES);
+    fprintf(stderr, "  -t  threads per process, default 1\n");
+    fprintf(stderr, "  -s  seed (Philox key), default %d\n", DEFAULT_SEED);
+    fprintf(stderr, "  -d  dimensions of the integral, default %d\n", DEFAULT_DIMS);
+    fprintf(stderr, "  -a  antithetic variates for the option\n");
+    fprintf(stderr, "  -k  sample kernel, default ispc when built with -DUSE_ISPC\n");
+    fprintf(stderr, "  -B  samples/s benchmark of the kernels, one thread and -t threads\n");
+}
+
+int main(int argc, char* argv[]) {
+    int provided, rank;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    const char* experiments = "all";
+    long long samples = DEFAULT_SAMPLES;
+    int num_threads = 1, benchmark = 0, bad = 0;
+    uint64_t seed = DEFAULT_SEED;
+    mc_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.dims = DEFAULT_DIMS;
+#ifdef USE_ISPC
+    cfg.use_ispc = 1;
+#endif
+
+    // Parse command line options (every rank parses the same argv)
+    int opt;
+    while ((opt = getopt(argc, argv, "e:n:t:s:d:ak:B")) != -1) {
+        switch (opt) {
+        case 'e': experiments = optarg; break;
+        case 'n': samples = (long long)strtod(optarg, NULL); break;
+        case 't': num_threads = atoi(optarg); break;
+        case 's': seed = strtoull(optarg, NULL, 10); break;
+        case 'd': cfg.dims = atoi(optarg); break;
+        case 'a': cfg.antithetic = 1; break;
+        case 'k':
+            if (strcmp(optarg, "scalar") == 0) cfg.use_ispc = 0;
+#ifdef USE_ISPC
+            else if (strcmp(optarg, "ispc") == 0) cfg.use_ispc = 1;
+#endif
+            else bad = 1;
+            break;
+        case 'B': benchmark = 1; break;
+        default: bad = 1;
+        }
+    }
+    int all = strcmp(experiments, "all") == 0;
+    int selected[4] = { 0, all || strcmp(experiments, "pi") == 0, all || strcmp(experiments, "option") == 0,
+                        all || strcmp(experiments, "integrate") == 0 };
+    if (bad || !(selected[1] || selected[2] || selected[3]) || samples < 2 || num_threads < 1 ||
+        num_threads > MAX_THREADS || cfg.dims < 1) {
+        if (rank == 0) usage(argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+    cfg.key[0] = (uint32_t)seed;
+    cfg.key[1] = (uint32_t)(seed >> 32);
+
+    MPI_Datatype stats_type;
+    MPI_Op stats_op;
+    MPI_Type_contiguous(3, MPI_DOUBLE, &stats_type);
+    MPI_Type_commit(&stats_type);
+    MPI_Op_create(statsReduce, 0, &stats_op);    // not commutative: merge order stays rank order
+
+    for (int e = EXP_PI; e <= EXP_INTEGRATE; e++) {
+        if (!selected[e])
+            continue;
+        cfg.experiment = (experiment_t)e;
+        if (!benchmark) {
+            double elapsed;
+            mc_stats s = runExperiment(&cfg, samples, num_threads, stats_op, stats_type, &elapsed);
+            if (rank == 0) report(&cfg, &s, elapsed, num_threads);
+            continue;
+        }
+
+        // Benchmark: every kernel on one thread, then on -t threads
+        if (rank == 0)
+            printf("%-10s %-8s %8s %12s %14s %18s\n", experimentName(cfg.experiment), "kernel", "threads",
+                   "time s", "Msamples/s", "Msamples/s/thread");
+        int size;
+        MPI_Comm_size(MPI_COMM_WORLD, &size);
+        int use_ispc = cfg.use_ispc;
+        for (int k = 0; k <= use_ispc; k++) {
+            cfg.use_ispc = k;
+            for (int pass = 0; pass < 2; pass++) {
+                int threads = pass == 0 ? 1 : num_threads;
+                if (pass == 1 && num_threads == 1)
+                    break;
+                double elapsed;
+                mc_stats s = runExperiment(&cfg, samples, threads, stats_op, stats_type, &elapsed);
+                if (rank == 0)
+                    printf("%-10s %-8s %8d %12.3f %14.1f %18.1f\n", "", k ? "ispc" : "scalar", size * threads,
+                           elapsed, s.n / elapsed / 1e6, s.n / elapsed / 1e6 / (size * threads));
+            }
+        }
+        cfg.use_ispc = use_ispc;
+    }
+
+    MPI_Op_free(&stats_op);
+    MPI_Type_free(&stats_type);
+    MPI_Finalize();
+    return 0;
+}
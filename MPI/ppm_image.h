@@ -0,0 +1,264 @@
+// ppm_image.h
+// PPM (P6) writers shared by the MPI programs: iteration counts are mapped to colors
+// with colorizeRow() and written either serially or collectively with MPI-IO.
+// image_filters.c also reads and writes plain 8-bit PGM (P5) / PPM (P6) images
+// by bands of rows with MPI-IO.
+#ifndef PPM_IMAGE_H
+#define PPM_IMAGE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpi.h>
+
+// Function to convert one row of iteration counts to RGB (simple mapping)
+static inline void colorizeRow(const int* data, int width, int maxIterations, unsigned char* rgb) {
+    for (int i = 0; i < width; i++) {
+        int value = data[i];
+        unsigned char r, g, b;
+        if (value == maxIterations) {
+            r = g = b = 0;  // Black for points in the set
+        } else {
+            // Color gradient based on iteration count
+            value = value % 16;
+            r = (value * 16) % 256;
+            g = (value * 8) % 256;
+            b = (value * 32) % 256;
+        }
+        rgb[3 * i + 0] = r;
+        rgb[3 * i + 1] = g;
+        rgb[3 * i + 2] = b;
+    }
+}
+
+// Function to write the PPM image
+static inline void writePPMImage(int* data, int width, int height, const char* filename, int maxIterations) {
+    FILE* fp = fopen(filename, "wb");
+    if (!fp) {
+        fprintf(stderr, "Error: Unable to open output file '%s'\n", filename);
+        return;
+    }
+
+    // Write PPM header
+    fprintf(fp, "P6\n%d %d\n255\n", width, height);
+
+    // Write image data one row at a time
+    unsigned char* rgb = (unsigned char*)malloc((size_t)width * 3);
+    if (rgb == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed while writing '%s'\n", filename);
+        fclose(fp);
+        return;
+    }
+    for (int j = 0; j < height; j++) {
+        colorizeRow(data + (size_t)j * width, width, maxIterations, rgb);
+        fwrite(rgb, 1, (size_t)width * 3, fp);
+    }
+    free(rgb);
+    fclose(fp);
+}
+
+/*
+    Parallel PPM writer.
+    Every rank colorizes the rows it computed and writes them straight to their
+    place in the shared file with one collective MPI-IO call, so no rank ever
+    holds the whole image. rows[] lists the image row of each buffered row and
+    must be increasing (true for every schedule), which lets it describe the
+    rank's file view directly. Rank 0 writes the header.
+    Returns 1 on every rank if all ranks wrote successfully.
+*/
+static inline int writePPMImageMPI(const int* data, const int* rows, int num_rows, int width, int height,
+                                   const char* filename, int maxIterations, MPI_Comm comm) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+
+    char header[64];
+    int header_len = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", width, height);
+    MPI_Offset row_bytes = (MPI_Offset)width * 3;
+
+    MPI_File fh;
+    if (MPI_File_open(comm, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0)
+            fprintf(stderr, "Error: Unable to open output file '%s'\n", filename);
+        return 0;
+    }
+    // Drop whatever a previous, larger image left behind
+    MPI_File_set_size(fh, header_len + row_bytes * height);
+
+    if (rank == 0)
+        MPI_File_write_at(fh, 0, header, header_len, MPI_CHAR, MPI_STATUS_IGNORE);
+
+    unsigned char* rgb = (unsigned char*)malloc((size_t)num_rows * row_bytes + 1);
+    MPI_Aint* offsets = (MPI_Aint*)malloc((num_rows + 1) * sizeof(MPI_Aint));
+    if (rgb == NULL || offsets == NULL) {
+        fprintf(stderr, "Process %d: Memory allocation failed while writing '%s'\n", rank, filename);
+        MPI_Abort(comm, 1);
+    }
+    for (int j = 0; j < num_rows; j++) {
+        colorizeRow(data + (size_t)j * width, width, maxIterations, rgb + (size_t)j * row_bytes);
+        offsets[j] = (MPI_Aint)(rows[j] * row_bytes);
+    }
+
+    // The file view exposes only this rank's rows, so one write_all covers them all
+    MPI_Datatype row_type, file_type;
+    MPI_Type_contiguous((int)row_bytes, MPI_BYTE, &row_type);
+    MPI_Type_commit(&row_type);
+    MPI_Type_create_hindexed_block(num_rows, 1, offsets, row_type, &file_type);
+    MPI_Type_commit(&file_type);
+    MPI_File_set_view(fh, header_len, row_type, file_type, "native", MPI_INFO_NULL);
+    int ok = MPI_File_write_all(fh, rgb, num_rows, row_type, MPI_STATUS_IGNORE) == MPI_SUCCESS;
+    MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_LAND, comm);
+
+    MPI_Type_free(&file_type);
+    MPI_Type_free(&row_type);
+    MPI_File_close(&fh);
+    free(offsets);
+    free(rgb);
+    return ok;
+}
+
+// Header of a binary PGM (P5, 1 channel) or PPM (P6, 3 channels) image with maxval 255
+typedef struct {
+    int width, height, channels;
+    long offset;    // bytes before the first pixel
+} pnm_header;
+
+// Function to read the next header number, skipping whitespace and # comments; returns -1 on error
+static inline long readPNMNumber(FILE* fp) {
+    int c = fgetc(fp);
+    while (c == '#' || c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        if (c == '#') {
+            while (c != '\n' && c != EOF)
+                c = fgetc(fp);
+        }
+        c = fgetc(fp);
+    }
+    if (c < '0' || c > '9')
+        return -1;
+    long value = 0;
+    while (c >= '0' && c <= '9' && value < 1L << 30) {
+        value = value * 10 + (c - '0');
+        c = fgetc(fp);
+    }
+    // exactly one whitespace character ends the number (the last one may be followed by binary data)
+    if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+        return -1;
+    return value;
+}
+
+// Function to parse a P5/P6 header; returns 0 for malformed or unsupported (16-bit, ASCII) files
+static inline int parsePNMHeader(FILE* fp, pnm_header* header) {
+    char magic[2];
+    if (fread(magic, 1, 2, fp) != 2 || magic[0] != 'P' || (magic[1] != '5' && magic[1] != '6'))
+        return 0;
+    long width = readPNMNumber(fp);
+    long height = readPNMNumber(fp);
+    long maxval = readPNMNumber(fp);
+    if (width < 1 || height < 1 || maxval != 255)
+        return 0;
+    header->width = (int)width;
+    header->height = (int)height;
+    header->channels = magic[1] == '6' ? 3 : 1;
+    header->offset = ftell(fp);
+    return 1;
+}
+
+/*
+    Function to read the header of filename on rank 0 and share it with comm.
+    Returns 1 on every rank if the file is a P5/P6 image holding all its pixels.
+*/
+static inline int readPNMHeaderMPI(const char* filename, pnm_header* header, MPI_Comm comm) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    long fields[5] = { 0, 0, 0, 0, 0 };     // ok, width, height, channels, offset
+    if (rank == 0) {
+        FILE* fp = fopen(filename, "rb");
+        if (!fp) {
+            fprintf(stderr, "Error: Unable to open input file '%s'\n", filename);
+        } else {
+            if (!parsePNMHeader(fp, header)) {
+                fprintf(stderr, "Error: '%s' is not an 8-bit binary PGM (P5) or PPM (P6) image\n", filename);
+            } else {
+                fseek(fp, 0, SEEK_END);
+                long pixels = (long)header->width * header->height * header->channels;
+                if (ftell(fp) < header->offset + pixels) {
+                    fprintf(stderr, "Error: '%s' is shorter than its header says\n", filename);
+                } else {
+                    fields[0] = 1;
+                    fields[1] = header->width;
+                    fields[2] = header->height;
+                    fields[3] = header->channels;
+                    fields[4] = header->offset;
+                }
+            }
+            fclose(fp);
+        }
+    }
+    MPI_Bcast(fields, 5, MPI_LONG, 0, comm);
+    header->width = (int)fields[1];
+    header->height = (int)fields[2];
+    header->channels = (int)fields[3];
+    header->offset = fields[4];
+    return (int)fields[0];
+}
+
+/*
+    Function to read rows [first_row, first_row + num_rows) of the image into
+    pixels (interleaved bytes, row-major). Collective on comm, every rank
+    passes its own band. Returns 1 on every rank if all reads succeeded.
+*/
+static inline int readPNMRowsMPI(const char* filename, const pnm_header* header, int first_row, int num_rows,
+                                 unsigned char* pixels, MPI_Comm comm) {
+    MPI_File fh;
+    if (MPI_File_open(comm, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+        return 0;
+    MPI_Offset row_bytes = (MPI_Offset)header->width * header->channels;
+    // one element per row keeps the count small for any image size
+    MPI_Datatype row_type;
+    MPI_Type_contiguous((int)row_bytes, MPI_BYTE, &row_type);
+    MPI_Type_commit(&row_type);
+    MPI_Status status;
+    int ok = MPI_File_read_at_all(fh, header->offset + first_row * row_bytes, pixels, num_rows, row_type,
+                                  &status) == MPI_SUCCESS;
+    MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_LAND, comm);
+    MPI_Type_free(&row_type);
+    MPI_File_close(&fh);
+    return ok;
+}
+
+/*
+    Parallel PGM/PPM writer for 8-bit pixels (1 or 3 interleaved channels).
+    Every rank writes its band of rows [first_row, first_row + num_rows) with
+    one collective call, rank 0 writes the header. Returns 1 on every rank if
+    all ranks wrote successfully.
+*/
+static inline int writePNMImageMPI(const unsigned char* pixels, int first_row, int num_rows, int width, int height,
+                                   int channels, const char* filename, MPI_Comm comm) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+
+    char header[64];
+    int header_len = snprintf(header, sizeof(header), "P%c\n%d %d\n255\n", channels == 3 ? '6' : '5', width,
+                              height);
+    MPI_Offset row_bytes = (MPI_Offset)width * channels;
+
+    MPI_File fh;
+    if (MPI_File_open(comm, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0)
+            fprintf(stderr, "Error: Unable to open output file '%s'\n", filename);
+        return 0;
+    }
+    MPI_File_set_size(fh, header_len + row_bytes * height);
+    if (rank == 0)
+        MPI_File_write_at(fh, 0, header, header_len, MPI_CHAR, MPI_STATUS_IGNORE);
+
+    MPI_Datatype row_type;
+    MPI_Type_contiguous((int)row_bytes, MPI_BYTE, &row_type);
+    MPI_Type_commit(&row_type);
+    int ok = MPI_File_write_at_all(fh, header_len + first_row * row_bytes, pixels, num_rows, row_type,
+                                   MPI_STATUS_IGNORE) == MPI_SUCCESS;
+    MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_LAND, comm);
+    MPI_Type_free(&row_type);
+    MPI_File_close(&fh);
+    return ok;
+}
+
+#endif
@@ -0,0 +1,21 @@
+// splitmix64.h
+// splitmix64 finalizer (Steele et al., "Fast Splittable Pseudorandom Number Generators")
+#ifndef SPLITMIX64_H
+#define SPLITMIX64_H
+
+#include <stdint.h>
+
+/*
+    mix64() scrambles a 64-bit value into 64 well-mixed bits. Used as a
+    counter-based generator (element i is mix64 of i and a seed, so every rank
+    makes its own slice without communication) and as the hash behind the
+    decomposition-independent checksums.
+*/
+static inline uint64_t mix64(uint64_t z) {
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+#endif